@@ -3,90 +3,101 @@
 #include "keywords.h"
 #include "yaml-cpp/yaml.h"
 
+#include <algorithm>
+#include <cctype>
 #include <charconv>
 #include <expected>
 #include <locale>
 #include <optional>
-#include <regex>
 
 using namespace dynser;
 
-// https://stackoverflow.com/a/37516316
-namespace
-{
-template <class BidirIt, class Traits, class CharT, class UnaryFunction>
-std::basic_string<CharT>
-regex_replace(BidirIt first, BidirIt last, const std::basic_regex<CharT, Traits>& re, UnaryFunction f)
+config::yaml::DynRegexTemplate config::details::split_dyn_regex(const yaml::DynRegex& dyn_reg) noexcept
 {
-    std::basic_string<CharT> s;
-
-    typename std::match_results<BidirIt>::difference_type positionOfLastMatch = 0;
-    auto endOfLastMatch = first;
-
-    auto callback = [&](const std::match_results<BidirIt>& match) {
-        auto positionOfThisMatch = match.position(0);
-        auto diff = positionOfThisMatch - positionOfLastMatch;
-
-        auto startOfThisMatch = endOfLastMatch;
-        std::advance(startOfThisMatch, diff);
-
-        s.append(endOfLastMatch, startOfThisMatch);
-        s.append(f(match));
-
-        auto lengthOfMatch = match.length(0);
-
-        positionOfLastMatch = positionOfThisMatch + lengthOfMatch;
-
-        endOfLastMatch = startOfThisMatch;
-        std::advance(endOfLastMatch, lengthOfMatch);
-    };
-
-    std::regex_iterator<BidirIt> begin(first, last, re), end;
-    std::for_each(begin, end, callback);
-
-    s.append(endOfLastMatch, last);
+    yaml::DynRegexTemplate result{ .segments = { std::string{} }, .slots = {} };
+
+    std::size_t pos{};
+    while (pos < dyn_reg.size()) {
+        // '\_' followed by dyn-group number
+        const auto is_slot = dyn_reg[pos] == '\\' && pos + 2 < dyn_reg.size() && dyn_reg[pos + 1] == '_' &&
+                             std::isdigit(static_cast<unsigned char>(dyn_reg[pos + 2]));
+        if (!is_slot) {
+            result.segments.back() += dyn_reg[pos];
+            ++pos;
+            continue;
+        }
+        const auto number_begin = pos + 2;
+        auto number_end = number_begin;
+        while (number_end < dyn_reg.size() && std::isdigit(static_cast<unsigned char>(dyn_reg[number_end]))) {
+            ++number_end;
+        }
+        std::size_t gr_num{};
+        std::from_chars(dyn_reg.data() + number_begin, dyn_reg.data() + number_end, gr_num);
+        result.slots.push_back(gr_num);
+        result.segments.emplace_back();
+        pos = number_end;
+    }
 
-    return s;
+    return result;
 }
 
-template <class Traits, class CharT, class UnaryFunction>
-std::string regex_replace(const std::string& s, const std::basic_regex<CharT, Traits>& re, UnaryFunction f)
+config::yaml::Regex config::details::resolve_dyn_regex(
+    const yaml::DynRegexTemplate& dyn_reg,
+    const yaml::DynGroupValues& dyn_gr_vals
+) noexcept
 {
-    return regex_replace(s.cbegin(), s.cend(), re, f);
+    yaml::Regex result{ dyn_reg.segments.front() };
+    for (std::size_t i{}; i < dyn_reg.slots.size(); ++i) {
+        // missing dyn-groups are replaced with empty string
+        if (const auto found = dyn_gr_vals.find(dyn_reg.slots[i]); found != dyn_gr_vals.end()) {
+            result += found->second;
+        }
+        result += dyn_reg.segments[i + 1];
+    }
+    return result;
 }
-}    // namespace
 
 config::yaml::Regex
 config::details::resolve_dyn_regex(const yaml::DynRegex& dyn_reg, const yaml::DynGroupValues& dyn_gr_vals) noexcept
 {
-    static const std::regex dyn_gr_pattern{ R"(\\_(\d+))" };
-    return { regex_replace(dyn_reg, dyn_gr_pattern, [&dyn_gr_vals](const std::smatch& m) {
-        const auto gr_num = std::atoi(m.str(1).c_str());
-        if (dyn_gr_vals.contains(gr_num)) {
-            return dyn_gr_vals.at(gr_num);
-        }
-        return std::string{};
-    }) };
+    return resolve_dyn_regex(split_dyn_regex(dyn_reg), dyn_gr_vals);
 }
 
-regex::ToStringResult config::details::resolve_regex(const yaml::Regex& reg, const yaml::GroupValues& vals) noexcept
+regex::ParseResult config::details::compile_regex(const yaml::Regex& reg, const bool with_whole_match_group) noexcept
 {
     using namespace dynser::regex;
 
     auto reg_sus = regex::from_string(reg);
     if (!reg_sus) {
+        return reg_sus;
+    }
+    if (with_whole_match_group) {
+        reg_sus = Regex{ std::vector<Token>{ Group{ std::make_unique<Regex>(std::move(*reg_sus)),
+                                                    Quantifier{ 1, 1, false },
+                                                    0 } } };
+    }
+    // groups of pattern (nested ones too) are checked by one program
+    reg_sus->matcher = std::make_shared<const Matcher>(*reg_sus);
+    return reg_sus;
+}
+
+regex::ToStringResult
+config::details::resolve_regex(const regex::ParseResult& compiled_reg, const yaml::GroupValues& vals) noexcept
+{
+    using namespace dynser::regex;
+
+    if (!compiled_reg) {
         return std::unexpected{ ToStringError{
-            to_string_err::RegexSyntaxError{ reg_sus.error() },
+            to_string_err::RegexSyntaxError{ compiled_reg.error() },
             0    // group number
         } };
     }
-    const auto regex = !vals.contains(0)
-                           ? *reg_sus
-                           : Regex{ std::vector<Token>{ Group{ std::make_unique<Regex>(std::move(*reg_sus)),
-                                                               Quantifier{ 1, 1, false },
-                                                               std::regex{ reg.data(), reg.size() },
-                                                               0 } } };
-    return to_string(regex, vals);
+    return to_string(*compiled_reg, vals);
+}
+
+regex::ToStringResult config::details::resolve_regex(const yaml::Regex& reg, const yaml::GroupValues& vals) noexcept
+{
+    return resolve_regex(compile_regex(reg, vals.contains(0)), vals);
 }
 
 // config::from_string helpers
@@ -102,6 +113,92 @@ inline std::optional<Res> as_opt(YAML::Node const& node) noexcept(false)    // t
     return std::nullopt;
 };
 
+// lua syntax error, converted to ParseError in config::from_string
+struct ScriptSyntaxException
+{
+    YAML::Mark mark;
+    std::string msg;
+};
+
+inline lua::CompiledScript compile_script(YAML::Node const& node, std::string const& chunk_name) noexcept(false)
+{
+    auto compiled = lua::compile(node.as<std::string>(), chunk_name);
+    if (!compiled) {
+        throw ScriptSyntaxException{ node.Mark(), std::move(compiled.error()) };
+    }
+    return std::move(*compiled);
+}
+
+inline std::optional<lua::CompiledScript>
+compile_script_opt(YAML::Node const& node, std::string const& chunk_name) noexcept(false)
+{
+    if (node.IsDefined()) {
+        return compile_script(node, chunk_name);
+    }
+    return std::nullopt;
+}
+
+// for deserialization and debranching scripts: configs made for serialization only may leave them unfinished
+inline lua::CompileResult compile_script_lenient(YAML::Node const& node, std::string const& chunk_name) noexcept(false)
+{
+    return lua::compile(node.as<std::string>(), chunk_name);
+}
+
+inline std::optional<lua::CompileResult>
+compile_script_lenient_opt(YAML::Node const& node, std::string const& chunk_name) noexcept(false)
+{
+    if (node.IsDefined()) {
+        return compile_script_lenient(node, chunk_name);
+    }
+    return std::nullopt;
+}
+
+/**
+ * \brief Check if regex is a plain string (like 'abc' or '\[ ').
+ */
+bool is_literal(const regex::Regex& reg) noexcept
+{
+    using namespace dynser::regex;
+
+    return std::ranges::all_of(reg.value, [](const Token& tok) {
+        if (std::holds_alternative<Empty>(tok)) {
+            return true;
+        }
+        const auto* const character_class = std::get_if<CharacterClass>(&tok);
+        if (!character_class || character_class->is_negative || character_class->quantifier != without_quantifier) {
+            return false;
+        }
+        const auto& chars = character_class->characters;
+        if (chars.size() == 1) {
+            return chars[0] != '\\';
+        }
+        // escaped character, but not a class escape
+        return chars.size() == 2 && chars[0] == '\\' && !std::string_view{ "dDwWsS" }.contains(chars[1]);
+    });
+}
+
+/**
+ * \brief Parse linear rule pattern once, if it's known on config load, otherwise split it by dyn-groups.
+ * Output of literal patterns is built here too.
+ */
+template <config::yaml::LikeLinear Rule>
+inline Rule with_compiled_pattern(Rule&& rule) noexcept
+{
+    if (rule.dyn_groups) {
+        rule.dyn_pattern = config::details::split_dyn_regex(rule.pattern);
+    }
+    else {
+        rule.compiled_pattern = config::details::compile_regex(rule.pattern, rule.fields && rule.fields->contains(0));
+        const auto& compiled = *rule.compiled_pattern;
+        if (compiled && (!rule.fields || rule.fields->empty()) && is_literal(*compiled)) {
+            if (auto literal = regex::to_string(*compiled, {})) {
+                rule.literal = std::move(*literal);
+            }
+        }
+    }
+    return std::move(rule);
+}
+
 }    // namespace
 
 config::ParseResult config::from_string(const std::string_view sv) noexcept
@@ -133,10 +230,10 @@ config::ParseResult config::from_string(const std::string_view sv) noexcept
                                         as_opt<bool>(rule[keywords::CONTINUAL_EXISTING_REQUIRED]).value_or(true) });
                             }
                             else if (const auto rule = continual_rule_type[keywords::CONTINUAL_LINEAR]) {
-                                nested.push_back(ConLinear{
+                                nested.push_back(with_compiled_pattern(ConLinear{
                                     .pattern = rule[keywords::CONTINUAL_LINEAR_PATTERN].as<std::string>(),
                                     .dyn_groups = as_opt<DynGroupValues>(rule[keywords::CONTINUAL_LINEAR_DYN_GROUPS]),
-                                    .fields = as_opt<GroupValues>(rule[keywords::CONTINUAL_LINEAR_FIELDS]) });
+                                    .fields = as_opt<GroupValues>(rule[keywords::CONTINUAL_LINEAR_FIELDS]) }));
                             }
                         }
 
@@ -147,6 +244,14 @@ config::ParseResult config::from_string(const std::string_view sv) noexcept
 
                         nested.branching_script = branched[keywords::BRANCHED_BRANCHING_SCRIPT].as<std::string>();
                         nested.debranching_script = branched[keywords::BRANCHED_DEBRANCHING_SCRIPT].as<std::string>();
+                        nested.branching_bytecode = compile_script(
+                            branched[keywords::BRANCHED_BRANCHING_SCRIPT],
+                            tag_name + ":" + keywords::BRANCHED_BRANCHING_SCRIPT
+                        );
+                        nested.debranching_bytecode = compile_script_lenient(
+                            branched[keywords::BRANCHED_DEBRANCHING_SCRIPT],
+                            tag_name + ":" + keywords::BRANCHED_DEBRANCHING_SCRIPT
+                        );
 
                         for (const auto branched_rule_type : branched[keywords::BRANCHED_RULES]) {
                             if (const auto rule = branched_rule_type[keywords::BRANCHED_EXISTING]) {
@@ -157,10 +262,10 @@ config::ParseResult config::from_string(const std::string_view sv) noexcept
                                         as_opt<bool>(rule[keywords::BRANCHED_EXISTING_REQUIRED]).value_or(true) });
                             }
                             else if (const auto rule = branched_rule_type[keywords::BRANCHED_LINEAR]) {
-                                nested.rules.push_back(BraLinear{
+                                nested.rules.push_back(with_compiled_pattern(BraLinear{
                                     .pattern = rule[keywords::BRANCHED_LINEAR_PATTERN].as<std::string>(),
                                     .dyn_groups = as_opt<DynGroupValues>(rule[keywords::BRANCHED_LINEAR_DYN_GROUPS]),
-                                    .fields = as_opt<GroupValues>(rule[keywords::BRANCHED_LINEAR_FIELDS]) });
+                                    .fields = as_opt<GroupValues>(rule[keywords::BRANCHED_LINEAR_FIELDS]) }));
                             }
                         }
 
@@ -184,7 +289,7 @@ config::ParseResult config::from_string(const std::string_view sv) noexcept
                                 });
                             }
                             else if (const auto rule = recurrent_rule_type[keywords::RECURRENT_LINEAR]) {
-                                nested.push_back(RecLinear{
+                                nested.push_back(with_compiled_pattern(RecLinear{
                                     .pattern = rule[keywords::RECURRENT_LINEAR_PATTERN].as<std::string>(),
                                     .dyn_groups = as_opt<DynGroupValues>(rule[keywords::RECURRENT_LINEAR_DYN_GROUPS]),
                                     .fields = as_opt<GroupValues>(rule[keywords::RECURRENT_LINEAR_FIELDS]),
@@ -193,16 +298,16 @@ config::ParseResult config::from_string(const std::string_view sv) noexcept
                                         as_opt<std::string>(rule[keywords::RECURRENT_LINEAR_DEFAULT_VALUE]),
                                     .priority =
                                         as_opt<PriorityType>(rule[keywords::RECURRENT_LINEAR_PRIORITY]).value_or(0),
-                                });
+                                }));
                             }
                             else if (const auto rule = recurrent_rule_type[keywords::RECURRENT_INFIX]) {
-                                nested.push_back(RecInfix{
+                                nested.push_back(with_compiled_pattern(RecInfix{
                                     .pattern = rule[keywords::RECURRENT_INFIX_PATTERN].as<std::string>(),
                                     .dyn_groups = as_opt<DynGroupValues>(rule[keywords::RECURRENT_INFIX_DYN_GROUPS]),
                                     .fields = as_opt<GroupValues>(rule[keywords::RECURRENT_INFIX_FIELDS]),
                                     .wrap = as_opt<bool>(rule[keywords::RECURRENT_INFIX_WRAP]).value_or(false),
                                     .default_value = as_opt<std::string>(rule[keywords::RECURRENT_INFIX_DEFAULT_VALUE]),
-                                });
+                                }));
                             }
                         }
 
@@ -219,6 +324,12 @@ config::ParseResult config::from_string(const std::string_view sv) noexcept
                 }(),
                 .serialization_script = as_opt<Script>(tag[keywords::SERIALIZATION_SCRIPT]),
                 .deserialization_script = as_opt<Script>(tag[keywords::DESERIALIZATION_SCRIPT]),
+                .serialization_bytecode = compile_script_opt(
+                    tag[keywords::SERIALIZATION_SCRIPT], tag_name + ":" + keywords::SERIALIZATION_SCRIPT
+                ),
+                .deserialization_bytecode = compile_script_lenient_opt(
+                    tag[keywords::DESERIALIZATION_SCRIPT], tag_name + ":" + keywords::DESERIALIZATION_SCRIPT
+                ),
             };
         }
 
@@ -226,6 +337,9 @@ config::ParseResult config::from_string(const std::string_view sv) noexcept
 
         return result;
     }
+    catch (ScriptSyntaxException& ex) {
+        return std::unexpected{ ParseError{ ParseError::Type::ScriptSyntaxError, ex.mark, ex.msg } };
+    }
     catch (YAML::ParserException& ex) {
         return std::unexpected{ ParseError{ ParseError::Type::ParserException, ex.mark, ex.msg } };
     }
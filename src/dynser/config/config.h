@@ -10,8 +10,23 @@ namespace dynser::config
 namespace details
 {
 
+/**
+ * \brief Split pattern by dyn-group slots ('\_N').
+ */
+yaml::DynRegexTemplate split_dyn_regex(const yaml::DynRegex& dyn_reg) noexcept;
+
+yaml::Regex
+resolve_dyn_regex(const yaml::DynRegexTemplate& dyn_reg, const yaml::DynGroupValues& dyn_gr_vals) noexcept;
+
 yaml::Regex resolve_dyn_regex(const yaml::DynRegex& dyn_reg, const yaml::DynGroupValues& dyn_gr_vals) noexcept;
 
+/**
+ * \brief Parse pattern, wrap it into group 0 if whole match value is requested.
+ */
+regex::ParseResult compile_regex(const yaml::Regex& reg, bool with_whole_match_group) noexcept;
+
+regex::ToStringResult resolve_regex(const regex::ParseResult& compiled_reg, const yaml::GroupValues& vals) noexcept;
+
 regex::ToStringResult resolve_regex(const yaml::Regex& reg, const yaml::GroupValues& vals) noexcept;
 
 }    // namespace details
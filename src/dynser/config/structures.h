@@ -1,5 +1,7 @@
 #pragma once
 
+#include "lua/script.h"
+#include "regex/from_string.h"
 #include "yaml-cpp/yaml.h"
 #include <unordered_map>
 
@@ -9,6 +11,7 @@
 #include <optional>
 #include <string>
 #include <variant>
+#include <vector>
 
 namespace dynser::config
 {
@@ -31,6 +34,13 @@ using Regex = std::string;
 
 using DynRegex = std::string;
 
+// DynRegex split by '\_N' dyn-group slots
+struct DynRegexTemplate
+{
+    std::vector<std::string> segments;    // literal parts, one more than slots
+    std::vector<std::size_t> slots;       // dyn-group numbers
+};
+
 using GroupValues = std::unordered_map<std::size_t, std::string>;
 
 using DynGroupValues = std::unordered_map<std::size_t, std::string>;
@@ -67,6 +77,13 @@ struct ConLinear
     yaml::Regex pattern;
     std::optional<DynGroupValues> dyn_groups;
     std::optional<GroupValues> fields;
+
+    // parsed on config load, std::nullopt if pattern depends on dyn-groups
+    std::optional<regex::ParseResult> compiled_pattern{};
+    // output of pattern without groups and fields, built on config load
+    std::optional<std::string> literal{};
+    // split on config load if pattern depends on dyn-groups
+    std::optional<DynRegexTemplate> dyn_pattern{};
 };
 
 struct BraLinear
@@ -74,6 +91,13 @@ struct BraLinear
     yaml::Regex pattern;
     std::optional<DynGroupValues> dyn_groups;
     std::optional<GroupValues> fields;
+
+    // parsed on config load, std::nullopt if pattern depends on dyn-groups
+    std::optional<regex::ParseResult> compiled_pattern{};
+    // output of pattern without groups and fields, built on config load
+    std::optional<std::string> literal{};
+    // split on config load if pattern depends on dyn-groups
+    std::optional<DynRegexTemplate> dyn_pattern{};
 };
 
 struct RecLinear
@@ -85,6 +109,13 @@ struct RecLinear
     bool wrap;
     std::optional<std::string> default_value;
     PriorityType priority;
+
+    // parsed on config load, std::nullopt if pattern depends on dyn-groups
+    std::optional<regex::ParseResult> compiled_pattern{};
+    // output of pattern without groups and fields, built on config load
+    std::optional<std::string> literal{};
+    // split on config load if pattern depends on dyn-groups
+    std::optional<DynRegexTemplate> dyn_pattern{};
 };
 
 struct RecInfix
@@ -95,6 +126,13 @@ struct RecInfix
 
     bool wrap;
     std::optional<std::string> default_value;
+
+    // parsed on config load, std::nullopt if pattern depends on dyn-groups
+    std::optional<regex::ParseResult> compiled_pattern{};
+    // output of pattern without groups and fields, built on config load
+    std::optional<std::string> literal{};
+    // split on config load if pattern depends on dyn-groups
+    std::optional<DynRegexTemplate> dyn_pattern{};
 };
 
 using Continual = std::vector<std::variant<ConExisting, ConLinear>>;
@@ -104,6 +142,10 @@ struct Branched
     Script branching_script;
     Script debranching_script;
 
+    // compiled on config load, syntax error of debranching script is reported when it runs
+    lua::CompiledScript branching_bytecode;
+    lua::CompileResult debranching_bytecode;
+
     using Rules = std::variant<BraExisting, BraLinear>;
     std::vector<Rules> rules;
 };
@@ -121,6 +163,10 @@ struct Tag
     Nested nested;
     std::optional<Script> serialization_script;
     std::optional<Script> deserialization_script;
+
+    // compiled on config load, syntax error of deserialization script is reported when it runs
+    std::optional<lua::CompiledScript> serialization_bytecode;
+    std::optional<lua::CompileResult> deserialization_bytecode;
 };
 
 using Tags = std::unordered_map<std::string, Tag>;
@@ -158,7 +204,8 @@ struct ParseError
         ParserException,
         RepresentationException,
         UnknownYamlCppException,
-        UnknownException,    // mark and msg invalid
+        ScriptSyntaxError,    // mark points to script, msg is lua error message
+        UnknownException,     // mark and msg invalid
     } type;
     YAML::Mark mark;
     std::string msg;
@@ -173,6 +220,12 @@ struct Config
     void merge(Config&&) noexcept;
 };
 
+/**
+ * \brief Loaded config (scripts and patterns are already compiled), immutable after load.
+ * Shared between serializer instances, e.g. one instance per thread.
+ */
+using CompiledConfig = Config;
+
 using ParseResult = std::expected<Config, ParseError>;
 
 }    // namespace dynser::config
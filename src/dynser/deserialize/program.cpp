@@ -0,0 +1,1332 @@
+#include "program.h"
+
+#include "util/prefix.hpp"
+#include "util/visit.hpp"
+#include <unordered_set>
+
+#include <algorithm>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+
+// deserialize::Program impl
+namespace
+{
+
+using dynser::deserialize::Program;
+using Instruction = Program::Instruction;
+using Type = Instruction::Type;
+
+constexpr auto npos = std::numeric_limits<std::size_t>::max();
+
+// TagBegin of top-level tag has no call instruction
+constexpr auto top_call = std::numeric_limits<std::uint32_t>::max();
+
+// TagInfo instruction is not set (e.g. element entry of not recurrent tag)
+constexpr auto no_pc = std::numeric_limits<std::uint32_t>::max();
+
+// script is not run (e.g. on recurrent tag end), properties are empty
+constexpr auto no_result = std::numeric_limits<std::uint32_t>::max();
+
+// ElementEnd::x
+constexpr std::uint32_t recurrent_element = 0;
+constexpr std::uint32_t recurrent_dict_element = 1;
+
+// alternatives of one linear rule match, more are never tried (e.g. nested unbounded quantifiers)
+constexpr std::size_t max_linear_alternatives = 4096;
+
+// remembered left recursion contexts of failed call (more are just not remembered)
+constexpr std::size_t max_failure_contexts = 8;
+
+// estimated size of one memoized property (key, value and map node)
+constexpr std::size_t memo_property_bytes = 64;
+
+// first bound of left recursion depth, one nested call covers most grammars (e.g. `token: disjunction | ...`)
+constexpr std::size_t initial_left_recursion_depth = 2;
+
+// deeper brackets nesting of element is not checked (element is considered not separable)
+constexpr std::size_t max_separation_depth = 16;
+
+template <dynser::config::yaml::LikeLinear Rule>
+Program::Linear make_linear(Rule const& rule) noexcept
+{
+    Program::Linear result;
+    if (rule.literal) {
+        result.literal = *rule.literal;
+    }
+    else if (rule.compiled_pattern && *rule.compiled_pattern) {
+        // compiled on config load
+        result.matcher.emplace(*(*rule.compiled_pattern)->matcher);
+    }
+    else if (rule.dyn_pattern) {
+        result.dyn_pattern = &*rule.dyn_pattern;
+        result.dyn_groups = &*rule.dyn_groups;
+    }
+    // else pattern has syntax error, rule never matches
+    result.with_whole_match_group = rule.fields && rule.fields->contains(0);
+    if (rule.fields) {
+        for (auto const& [group_number, field_name] : *rule.fields) {
+            result.fields.emplace_back(group_number, field_name);
+        }
+    }
+    return result;
+}
+
+}    // namespace
+
+struct dynser::deserialize::Program::Compiler
+{
+    Program& program;
+
+    std::uint32_t pc() const noexcept { return static_cast<std::uint32_t>(program.program_.size()); }
+
+    std::uint32_t emit(Instruction&& instruction) noexcept
+    {
+        program.program_.push_back(std::move(instruction));
+        return pc() - 1;
+    }
+
+    template <config::yaml::LikeLinear Rule>
+    void compile_linear(Rule const& rule) noexcept
+    {
+        program.linears_.push_back(make_linear(rule));
+        emit({ .type = Type::Linear, .x = static_cast<std::uint32_t>(program.linears_.size() - 1) });
+    }
+
+    template <config::yaml::LikeExisting Rule>
+    void compile_existing(Rule const& rule) noexcept
+    {
+        // optional rule: split C, E; C: call; E:
+        const auto split = rule.required ? 0 : emit({ .type = Type::Split });
+        if (!rule.required) {
+            program.program_[split].x = pc();
+        }
+        if (const auto found = program.tag_indices_.find(rule.tag); found != program.tag_indices_.end()) {
+            std::uint32_t prefix{};
+            if (rule.prefix) {
+                program.prefixes_.push_back(*rule.prefix);
+                prefix = static_cast<std::uint32_t>(program.prefixes_.size());
+            }
+            emit({ .type = Type::Call, .x = found->second, .y = prefix });
+        }
+        else {
+            emit({ .type = Type::Fail });
+        }
+        if (!rule.required) {
+            program.program_[split].y = pc();
+        }
+    }
+
+    void compile_rule(auto const& rule) noexcept
+    {
+        util::visit_one(
+            rule,
+            [this](config::yaml::LikeExisting auto const& existing) { compile_existing(existing); },
+            [this](config::yaml::LikeLinear auto const& linear) { compile_linear(linear); }
+        );
+    }
+
+    void compile(TagInfo& info) noexcept
+    {
+        using namespace config::yaml;
+
+        info.entry = pc();
+        util::visit_one_terminated(
+            info.tag->nested,
+            [this](Continual const& continual) {
+                for (auto const& rule : continual) {
+                    compile_rule(rule);
+                }
+            },
+            [this](Branched const& branched) {
+                if (branched.rules.empty()) {
+                    emit({ .type = Type::Fail });
+                    return;
+                }
+                // split B0, N0
+                // B0: branch 0; rule; jump E
+                // N0: split B1, N1
+                // ...
+                // E:
+                std::vector<std::uint32_t> jumps;
+                for (std::size_t ind{}; ind < branched.rules.size(); ++ind) {
+                    const auto is_last = ind + 1 == branched.rules.size();
+                    const auto split = is_last ? 0 : emit({ .type = Type::Split });
+                    if (!is_last) {
+                        program.program_[split].x = pc();
+                    }
+                    emit({ .type = Type::Branch, .x = static_cast<std::uint32_t>(ind) });
+                    compile_rule(branched.rules[ind]);
+                    if (!is_last) {
+                        jumps.push_back(emit({ .type = Type::Jump }));
+                        program.program_[split].y = pc();
+                    }
+                }
+                for (const auto jump : jumps) {
+                    program.program_[jump].x = pc();
+                }
+            },
+            [this, &info](Recurrent const& recurrent) {
+                const auto infix = std::find_if(recurrent.begin(), recurrent.end(), [](auto const& rule) {
+                    return std::holds_alternative<RecInfix>(rule);
+                });
+                // L: split B, E
+                // B: element-begin; rules before infix; split I, N
+                // I: infix and rules after it; element-end; jump B (infix is followed by element)
+                // N: rules after infix (without infixes); element-end
+                // E:
+                const auto loop = emit({ .type = Type::Split });
+                program.program_[loop].x = pc();
+                const auto body = emit({ .type = Type::ElementBegin });
+                info.element_entry = body;
+                for (auto it = recurrent.begin(); it != infix; ++it) {
+                    compile_rule(*it);
+                }
+                if (infix != recurrent.end()) {
+                    const auto split = emit({ .type = Type::Split });
+                    info.infix_split = split;
+                    program.program_[split].x = pc();
+                    for (auto it = infix; it != recurrent.end(); ++it) {
+                        compile_rule(*it);
+                    }
+                    emit({ .type = Type::ElementEnd, .x = recurrent_element });
+                    emit({ .type = Type::Jump, .x = body });
+                    program.program_[split].y = pc();
+                    for (auto it = infix; it != recurrent.end(); ++it) {
+                        if (!std::holds_alternative<RecInfix>(*it)) {
+                            compile_rule(*it);
+                        }
+                    }
+                    emit({ .type = Type::ElementEnd, .x = recurrent_element });
+                }
+                else {
+                    emit({ .type = Type::ElementEnd, .x = recurrent_element });
+                    emit({ .type = Type::Jump, .x = loop });
+                }
+                program.program_[loop].y = pc();
+            },
+            [this, &info](RecurrentDict const& recurrent_dict) {
+                // L: split B, E
+                // B: element-begin; call; element-end; jump L
+                // E:
+                info.dict_key = &recurrent_dict.key;
+                const auto loop = emit({ .type = Type::Split });
+                program.program_[loop].x = pc();
+                emit({ .type = Type::ElementBegin });
+                compile_existing(ConExisting{ .tag = recurrent_dict.tag, .prefix = std::nullopt, .required = true });
+                emit({ .type = Type::ElementEnd, .x = recurrent_dict_element });
+                emit({ .type = Type::Jump, .x = loop });
+                program.program_[loop].y = pc();
+            }
+        );
+        emit({ .type = Type::Return });
+    }
+};
+
+struct dynser::deserialize::Program::Executor
+{
+    /**
+     * \brief Matched rules log, truncated on backtrack. Properties are built from it after whole match.
+     */
+    struct Event
+    {
+        enum class Type : std::uint8_t {
+            TagBegin,        // x: call instruction, y: tag, begin: position, end: call choice, link: caller frame,
+                             // saved: caller element
+            TagEnd,          // x: scripts result, link: frame
+            Capture,         // x: linear rule, y: field index, [begin, end): value
+            Branch,          // x: branch index
+            ElementBegin,    // begin: position
+            ElementEnd,      // x: scripts result, y: element kind, link: element begin
+        } type;
+        std::uint32_t x{};
+        std::uint32_t y{};
+        std::size_t begin{};
+        std::size_t end{};
+        std::size_t link{};
+        std::size_t saved{};
+    };
+
+    /**
+     * \brief Linear rule match, alternative to first one.
+     */
+    struct Candidate
+    {
+        std::size_t length;
+        std::vector<std::size_t> spans;    // begin and end for every field, npos if not set
+    };
+
+    /**
+     * \brief Match of called tag: events from its TagBegin to TagEnd and results of its scripts,
+     * indices are relative to segment begin.
+     */
+    struct MemoReturn
+    {
+        std::size_t end;
+        std::vector<Event> events;
+        std::vector<Properties> results;
+    };
+
+    using MemoReturns = std::vector<MemoReturn>;
+
+    /**
+     * \brief State to restore on backtrack.
+     */
+    struct Choice
+    {
+        std::uint32_t pc;    // Split: alternative, Linear: rule instruction, call: tag
+        std::size_t pos;
+        std::size_t frame;
+        std::size_t element;
+        std::size_t trail_size;
+        std::size_t results_size;
+        bool is_linear{};
+
+        // not an alternative, marks call to remember it if it fails without return
+        bool is_call{};
+        bool is_returned{};
+        bool is_context_dependent{};    // left recursion was cut at call position
+
+        // call was entered before at same position, its matches are recorded to memoize
+        bool is_recording{};
+        MemoReturns returns{};
+        std::size_t returns_bytes{};
+
+        // not an alternative, replays memoized matches of call instruction pc
+        bool is_replay{};
+        std::shared_ptr<const MemoReturns> replayed{};
+        std::size_t next_return{};
+
+        // enumerated on first backtrack into linear rule
+        bool is_enumerated{};
+        std::vector<Candidate> candidates{};
+        std::size_t next_candidate{};
+    };
+
+    /**
+     * \brief Memoized matches of calls by failed_call_key, limited by estimated size.
+     */
+    struct Memo
+    {
+        struct Entry
+        {
+            std::size_t key;
+            std::shared_ptr<const MemoReturns> returns;
+            std::size_t bytes;
+        };
+
+        MemoOptions options;
+        std::list<Entry> entries{};    // most recently used first
+        std::unordered_map<std::size_t, std::list<Entry>::iterator> index{};
+        std::size_t bytes{};
+
+        std::shared_ptr<const MemoReturns> find(const std::size_t key) noexcept
+        {
+            const auto found = index.find(key);
+            if (found == index.end()) {
+                return nullptr;
+            }
+            entries.splice(entries.begin(), entries, found->second);
+            return found->second->returns;
+        }
+
+        void insert(const std::size_t key, MemoReturns&& returns, const std::size_t entry_bytes) noexcept
+        {
+            if (index.contains(key) || entry_bytes > options.max_bytes ||
+                (options.eviction == MemoEviction::DropNew && bytes + entry_bytes > options.max_bytes))
+            {
+                return;
+            }
+            while (bytes + entry_bytes > options.max_bytes) {
+                bytes -= entries.back().bytes;
+                index.erase(entries.back().key);
+                entries.pop_back();
+            }
+            entries.push_front({ key, std::make_shared<const MemoReturns>(std::move(returns)), entry_bytes });
+            index.emplace(key, entries.begin());
+            bytes += entry_bytes;
+        }
+    };
+
+    Program const& program;
+    std::string_view subject;
+    ResolveDynPattern const& resolve_dyn_pattern;
+    RunScripts const& run_scripts;
+    std::size_t max_left_recursion_depth;
+
+    // stop on end of first element of top-level recurrent tag
+    bool is_element_run{};
+    bool is_last_element{};
+
+    // registers
+    std::uint32_t pc{};
+    std::size_t pos{};
+    std::size_t frame{ npos };      // TagBegin of current tag
+    std::size_t element{ npos };    // ElementBegin of current element
+
+    std::vector<Event> trail{};
+    std::vector<Properties> results{};
+    std::vector<Choice> choices{};
+
+    // resolved on first use, matchers of caller may be evicted from its cache
+    std::unordered_map<std::uint32_t, std::optional<regex::Matcher>> dyn_matchers{};
+    std::vector<FieldSpan> fields_buffer{};
+
+    // tag and count of calls in frames chain at same position
+    using CallsContext = std::vector<std::pair<std::uint32_t, std::size_t>>;
+
+    // calls (by position and tag) which never return: they fail again if left recursion is cut not later
+    std::unordered_map<std::size_t, std::vector<CallsContext>> failed_calls{};
+
+    // calls (by position and tag) entered at least once
+    std::unordered_set<std::size_t> entered_calls{};
+    Memo memo{ .options = program.memo_ };
+
+    std::size_t furthest{};
+    std::optional<std::string> script_error{};
+    bool is_depth_exceeded{};    // some left recursion was cut by max_left_recursion_depth only
+    bool hit_end{};              // some rule needed input after end of subject
+
+    Choice snapshot(const std::uint32_t choice_pc, const bool is_linear) const noexcept
+    {
+        return { .pc = choice_pc,
+                 .pos = pos,
+                 .frame = frame,
+                 .element = element,
+                 .trail_size = trail.size(),
+                 .results_size = results.size(),
+                 .is_linear = is_linear };
+    }
+
+    void note_failure(const std::size_t at, std::optional<std::string>&& error = std::nullopt) noexcept
+    {
+        if (at >= furthest) {
+            furthest = at;
+            script_error = std::move(error);
+        }
+    }
+
+    regex::Matcher const* matcher_of(const std::uint32_t linear_ind) noexcept
+    {
+        auto const& linear = program.linears_[linear_ind];
+        if (linear.matcher) {
+            return &*linear.matcher;
+        }
+        if (!linear.dyn_pattern) {
+            return nullptr;
+        }
+        auto found = dyn_matchers.find(linear_ind);
+        if (found == dyn_matchers.end()) {
+            auto const* const resolved = resolve_dyn_pattern(linear);
+            found = dyn_matchers.emplace(linear_ind, resolved ? std::optional{ *resolved } : std::nullopt).first;
+        }
+        return found->second ? &*found->second : nullptr;
+    }
+
+    void push_captures(const std::uint32_t linear_ind, const std::size_t* const spans) noexcept
+    {
+        auto const& fields = program.linears_[linear_ind].fields;
+        for (std::size_t ind{}; ind < fields.size(); ++ind) {
+            if (spans[2 * ind] != npos) {
+                trail.push_back({ .type = Event::Type::Capture,
+                                  .x = linear_ind,
+                                  .y = static_cast<std::uint32_t>(ind),
+                                  .begin = pos + spans[2 * ind],
+                                  .end = pos + spans[2 * ind + 1] });
+            }
+        }
+    }
+
+    /**
+     * \brief Spans of fields of linear rule in match (relative to match begin).
+     */
+    void field_spans(
+        regex::Matcher const& matcher,
+        regex::Matcher::PrefixMatch const& match,
+        const std::uint32_t linear_ind,
+        std::vector<std::size_t>& out
+    ) const noexcept
+    {
+        out.clear();
+        for (auto const& [group_number, field_name] : program.linears_[linear_ind].fields) {
+            const auto span = matcher.group_span(match, group_number);
+            out.push_back(span ? span->first : npos);
+            out.push_back(span ? span->second : npos);
+        }
+    }
+
+    bool match_linear() noexcept
+    {
+        const auto linear_ind = program.program_[pc].x;
+        auto const& linear = program.linears_[linear_ind];
+        const auto rest = subject.substr(pos);
+
+        if (linear.literal) {
+            if (!rest.starts_with(*linear.literal)) {
+                if (linear.literal->starts_with(rest)) {
+                    hit_end = true;
+                }
+                note_failure(pos);
+                return false;
+            }
+            pos += linear.literal->size();
+            ++pc;
+            return true;
+        }
+
+        auto const* const matcher = matcher_of(linear_ind);
+        if (!matcher) {
+            note_failure(pos);
+            return false;
+        }
+        auto choice = snapshot(pc, true);
+        std::vector<std::size_t> spans;
+        std::size_t length{};
+        bool is_partial{};
+        const auto is_matched = matcher->match_prefixes(
+            rest,
+            [&](regex::Matcher::PrefixMatch const& match) {
+                field_spans(*matcher, match, linear_ind, spans);
+                length = match.length;
+                return true;
+            },
+            is_partial
+        );
+        hit_end = hit_end || is_partial;
+        if (!is_matched) {
+            note_failure(pos);
+            return false;
+        }
+        push_captures(linear_ind, spans.data());
+        pos += length;
+        ++pc;
+        // other matches are tried on backtrack
+        choices.push_back(std::move(choice));
+        return true;
+    }
+
+    /**
+     * \brief Continue from next alternative match of linear rule of choice (state is already restored).
+     */
+    bool next_linear_candidate(Choice& choice) noexcept
+    {
+        const auto linear_ind = program.program_[choice.pc].x;
+        auto const* const matcher = matcher_of(linear_ind);
+        if (!choice.is_enumerated) {
+            choice.is_enumerated = true;
+            bool is_first{ true };
+            bool is_partial{};
+            matcher->match_prefixes(
+                subject.substr(pos),
+                [&](regex::Matcher::PrefixMatch const& match) {
+                    if (is_first) {
+                        is_first = false;    // already tried
+                        return false;
+                    }
+                    Candidate candidate{ match.length, {} };
+                    field_spans(*matcher, match, linear_ind, candidate.spans);
+                    choice.candidates.push_back(std::move(candidate));
+                    return choice.candidates.size() >= max_linear_alternatives;
+                },
+                is_partial
+            );
+            hit_end = hit_end || is_partial;
+        }
+        if (choice.next_candidate >= choice.candidates.size()) {
+            return false;
+        }
+        auto const& candidate = choice.candidates[choice.next_candidate++];
+        push_captures(linear_ind, candidate.spans.data());
+        pos += candidate.length;
+        pc = choice.pc + 1;
+        return true;
+    }
+
+    bool backtrack() noexcept
+    {
+        while (!choices.empty()) {
+            auto& choice = choices.back();
+            pos = choice.pos;
+            frame = choice.frame;
+            element = choice.element;
+            trail.resize(choice.trail_size);
+            results.resize(choice.results_size);
+            if (choice.is_call) {
+                if (!choice.is_returned) {
+                    remember_failed_call(choice);
+                }
+                else if (choice.is_recording && !choice.is_context_dependent) {
+                    memo.insert(failed_call_key(choice.pc), std::move(choice.returns), choice.returns_bytes);
+                }
+                choices.pop_back();
+                continue;
+            }
+            if (choice.is_replay) {
+                if (choice.next_return < choice.replayed->size()) {
+                    replay((*choice.replayed)[choice.next_return++], choice.pc);
+                    return true;
+                }
+                choices.pop_back();
+                continue;
+            }
+            if (!choice.is_linear) {
+                pc = choice.pc;
+                choices.pop_back();
+                return true;
+            }
+            if (next_linear_candidate(choice)) {
+                return true;
+            }
+            choices.pop_back();
+        }
+        return false;
+    }
+
+    /**
+     * \brief Captures and branch of current tag (or element) since begin event, nested tags are skipped.
+     */
+    std::optional<std::size_t> collect_fields(const std::size_t begin) noexcept
+    {
+        fields_buffer.clear();
+        std::optional<std::size_t> branch;
+        for (auto ind = trail.size(); ind-- > begin + 1;) {
+            auto const& event = trail[ind];
+            switch (event.type) {
+                case Event::Type::TagEnd:
+                    ind = event.link;
+                    break;
+                case Event::Type::Capture:
+                    fields_buffer.push_back(
+                        { program.linears_[event.x].fields[event.y].second,
+                          subject.substr(event.begin, event.end - event.begin) }
+                    );
+                    break;
+                case Event::Type::Branch:
+                    branch = event.x;
+                    break;
+                default:
+                    break;
+            }
+        }
+        // later captures of same field take precedence
+        std::reverse(fields_buffer.begin(), fields_buffer.end());
+        return branch;
+    }
+
+    /**
+     * \return index of result, std::nullopt if scripts rejected fields.
+     */
+    std::optional<std::uint32_t> run_scripts_since(const std::size_t begin, const std::uint32_t tag) noexcept
+    {
+        const auto branch = collect_fields(begin);
+        auto result = run_scripts({ *program.tags_[tag].tag, fields_buffer, branch });
+        if (!result) {
+            note_failure(pos, std::move(result.error()));
+            return std::nullopt;
+        }
+        results.push_back(std::move(*result));
+        return static_cast<std::uint32_t>(results.size() - 1);
+    }
+
+    std::size_t failed_call_key(const std::uint32_t tag) const noexcept { return pos * program.tags_.size() + tag; }
+
+    CallsContext calls_context() const noexcept
+    {
+        CallsContext result;
+        for (auto caller = frame; caller != npos && trail[caller].begin == pos; caller = trail[caller].link) {
+            const auto found = std::find_if(result.begin(), result.end(), [&](auto const& tag_count) {
+                return tag_count.first == trail[caller].y;
+            });
+            if (found != result.end()) {
+                ++found->second;
+            }
+            else {
+                result.emplace_back(trail[caller].y, 1);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * \brief Failures of calls in frames chain at current position depend on cut left recursion.
+     */
+    void mark_context_dependent() noexcept
+    {
+        for (auto caller = frame; caller != npos && trail[caller].begin == pos; caller = trail[caller].link) {
+            if (trail[caller].end != npos) {
+                choices[trail[caller].end].is_context_dependent = true;
+            }
+        }
+    }
+
+    /**
+     * \param choice call choice, state is restored to call.
+     */
+    void remember_failed_call(Choice const& choice) noexcept
+    {
+        auto& contexts = failed_calls[failed_call_key(choice.pc)];
+        if (!choice.is_context_dependent) {
+            contexts.assign(1, {});    // fails in any context
+        }
+        else if (contexts.size() < max_failure_contexts) {
+            contexts.push_back(calls_context());
+        }
+    }
+
+    /**
+     * \brief Call failed before in context with not more calls in frames chain at current position.
+     */
+    bool is_failed_call(const std::uint32_t tag) noexcept
+    {
+        const auto found = failed_calls.find(failed_call_key(tag));
+        if (found == failed_calls.end()) {
+            return false;
+        }
+        const auto current = calls_context();
+        const auto count_of = [&current](const std::uint32_t of) -> std::size_t {
+            const auto it = std::find_if(current.begin(), current.end(), [of](auto const& tag_count) {
+                return tag_count.first == of;
+            });
+            return it != current.end() ? it->second : 0;
+        };
+        for (auto const& context : found->second) {
+            if (std::ranges::all_of(context, [&](auto const& tag_count) {
+                    return count_of(tag_count.first) >= tag_count.second;
+                }))
+            {
+                if (!context.empty()) {
+                    mark_context_dependent();
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool call() noexcept
+    {
+        const auto tag = program.program_[pc].x;
+        // left recursion: tag is called again at the same position, every cycle must consume something
+        std::size_t same_calls{};
+        for (auto caller = frame; caller != npos && trail[caller].begin == pos; caller = trail[caller].link) {
+            same_calls += trail[caller].y == tag;
+        }
+        if (same_calls > subject.size() - pos || same_calls >= max_left_recursion_depth) {
+            is_depth_exceeded |= same_calls <= subject.size() - pos;
+            mark_context_dependent();
+            return false;
+        }
+        if (is_failed_call(tag)) {
+            return false;
+        }
+        const auto key = failed_call_key(tag);
+        if (auto replayed = memo.find(key)) {
+            const auto call_pc = pc;
+            auto choice = snapshot(call_pc, false);
+            choice.is_replay = true;
+            choice.replayed = std::move(replayed);
+            choice.next_return = 1;
+            choices.push_back(std::move(choice));
+            replay(choices.back().replayed->front(), call_pc);
+            return true;
+        }
+        auto choice = snapshot(tag, false);
+        choice.is_call = true;
+        // first call is not recorded: most calls are never repeated
+        choice.is_recording = memo.options.max_bytes != 0 && !entered_calls.insert(key).second;
+        choices.push_back(std::move(choice));
+        enter(pc, tag, choices.size() - 1);
+        return true;
+    }
+
+    void enter(const std::uint32_t call_pc, const std::uint32_t tag, const std::size_t call_choice) noexcept
+    {
+        trail.push_back({ .type = Event::Type::TagBegin,
+                          .x = call_pc,
+                          .y = tag,
+                          .begin = pos,
+                          .end = call_choice,
+                          .link = frame,
+                          .saved = element });
+        frame = trail.size() - 1;
+        element = npos;
+        pc = program.tags_[tag].entry;
+    }
+
+    static std::size_t estimate_bytes(MemoReturn const& match) noexcept
+    {
+        auto result = sizeof(MemoReturn) + match.events.size() * sizeof(Event);
+        for (auto const& props : match.results) {
+            result += sizeof(Properties) + props.size() * memo_property_bytes;
+        }
+        return result;
+    }
+
+    /**
+     * \brief Remember match of tag what is returning now (its TagEnd is pushed).
+     */
+    void record_return(Choice& call_choice) noexcept
+    {
+        const auto trail_base = call_choice.trail_size;
+        const auto results_base = static_cast<std::uint32_t>(call_choice.results_size);
+        MemoReturn match{ .end = pos,
+                          .events = { trail.begin() + static_cast<std::ptrdiff_t>(trail_base), trail.end() },
+                          .results = { results.begin() + static_cast<std::ptrdiff_t>(results_base), results.end() } };
+        for (std::size_t ind{}; ind < match.events.size(); ++ind) {
+            auto& event = match.events[ind];
+            switch (event.type) {
+                case Event::Type::TagBegin:
+                    // links of called tag are set on replay
+                    event.link = ind == 0 ? npos : event.link - trail_base;
+                    event.saved = ind == 0 || event.saved == npos ? npos : event.saved - trail_base;
+                    event.end = npos;
+                    break;
+                case Event::Type::TagEnd:
+                case Event::Type::ElementEnd:
+                    event.x = event.x == no_result ? no_result : event.x - results_base;
+                    event.link -= trail_base;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        call_choice.returns_bytes += estimate_bytes(match);
+        if (call_choice.returns_bytes > memo.options.max_bytes) {
+            // would not be memoized anyway
+            call_choice.is_recording = false;
+            call_choice.returns.clear();
+            return;
+        }
+        call_choice.returns.push_back(std::move(match));
+    }
+
+    /**
+     * \brief Append memoized match of tag called by call_pc instruction and continue after call.
+     */
+    void replay(MemoReturn const& match, const std::uint32_t call_pc) noexcept
+    {
+        const auto trail_base = trail.size();
+        const auto results_base = static_cast<std::uint32_t>(results.size());
+        for (std::size_t ind{}; ind < match.events.size(); ++ind) {
+            auto event = match.events[ind];
+            switch (event.type) {
+                case Event::Type::TagBegin:
+                    if (ind == 0) {
+                        // same tag may be called by other instruction (with other prefix)
+                        event.x = call_pc;
+                        event.link = frame;
+                        event.saved = element;
+                    }
+                    else {
+                        event.link += trail_base;
+                        event.saved = event.saved == npos ? npos : event.saved + trail_base;
+                    }
+                    break;
+                case Event::Type::TagEnd:
+                case Event::Type::ElementEnd:
+                    event.x = event.x == no_result ? no_result : event.x + results_base;
+                    event.link += trail_base;
+                    break;
+                default:
+                    break;
+            }
+            trail.push_back(event);
+        }
+        results.insert(results.end(), match.results.begin(), match.results.end());
+        pos = match.end;
+        pc = call_pc + 1;
+    }
+
+    /**
+     * \return false if scripts rejected fields or top-level tag doesn't match whole string.
+     */
+    bool ret() noexcept
+    {
+        const auto begin = trail[frame];
+        auto result = no_result;
+        if (!program.tags_[begin.y].dict_key &&
+            !std::holds_alternative<config::yaml::Recurrent>(program.tags_[begin.y].tag->nested))
+        {
+            const auto result_sus = run_scripts_since(frame, begin.y);
+            if (!result_sus) {
+                return false;
+            }
+            result = *result_sus;
+        }
+        trail.push_back({ .type = Event::Type::TagEnd, .x = result, .link = frame });
+        if (begin.end != npos) {
+            auto& call_choice = choices[begin.end];
+            call_choice.is_returned = true;
+            if (call_choice.is_recording) {
+                record_return(call_choice);
+            }
+        }
+        frame = begin.link;
+        element = begin.saved;
+        if (begin.x == top_call && pos != subject.size()) {
+            note_failure(pos);
+            return false;
+        }
+        pc = begin.x == top_call ? top_call : begin.x + 1;
+        return true;
+    }
+
+    bool element_end() noexcept
+    {
+        if (pos == trail[element].begin) {
+            return false;    // empty element, prevents infinite loop
+        }
+        const auto kind = program.program_[pc].x;
+        auto result = no_result;
+        if (kind == recurrent_element) {
+            const auto result_sus = run_scripts_since(element, trail[frame].y);
+            if (!result_sus) {
+                return false;
+            }
+            result = *result_sus;
+        }
+        trail.push_back({ .type = Event::Type::ElementEnd, .x = result, .y = kind, .link = element });
+        element = npos;
+        ++pc;
+        return true;
+    }
+
+    /**
+     * \brief Build properties from trail of whole match.
+     */
+    Properties assemble() noexcept
+    {
+        using List = PropertyValue::ListType<PropertyValue>;
+
+        struct Level
+        {
+            std::uint32_t call_pc;
+            std::uint32_t tag;
+            Properties props;    // of nested tags and elements
+            std::optional<Properties> element;
+        };
+
+        const auto take_result = [this](const std::uint32_t ind) {
+            return ind == no_result ? Properties{} : std::move(results[ind]);
+        };
+
+        std::vector<Level> levels;
+        for (auto const& event : trail) {
+            switch (event.type) {
+                case Event::Type::TagBegin:
+                    levels.push_back({ event.x, event.y, {}, std::nullopt });
+                    break;
+                case Event::Type::ElementBegin:
+                    levels.back().element.emplace();
+                    break;
+                case Event::Type::ElementEnd:
+                {
+                    auto& level = levels.back();
+                    // script output takes precedence over nested tags properties
+                    auto element_props = take_result(event.x);
+                    element_props.merge(*level.element);
+                    level.element.reset();
+                    if (is_element_run && levels.size() == 1) {
+                        return element_props;
+                    }
+                    if (event.y == recurrent_element) {
+                        for (auto& [key, value] : element_props) {
+                            auto& list = level.props.try_emplace(key, List{}).first->second;
+                            if (list.is_list()) {
+                                list.as_list().push_back(std::move(value));
+                            }
+                        }
+                    }
+                    else {
+                        auto const& key = *program.tags_[level.tag].dict_key;
+                        auto& list = level.props.try_emplace(key, List{}).first->second;
+                        list.as_list().push_back(PropertyValue{ std::move(element_props) });
+                    }
+                    break;
+                }
+                case Event::Type::TagEnd:
+                {
+                    auto level = std::move(levels.back());
+                    levels.pop_back();
+                    auto props = take_result(event.x);
+                    props.merge(level.props);
+                    if (auto const* const dict_key = program.tags_[level.tag].dict_key) {
+                        props.try_emplace(*dict_key, List{});    // empty recurrent-dict
+                    }
+                    if (levels.empty()) {
+                        return props;
+                    }
+                    auto& parent = levels.back();
+                    auto& target = parent.element ? *parent.element : parent.props;
+                    const auto prefix = program.program_[level.call_pc].y;
+                    for (auto& [key, value] : props) {
+                        auto prefixed_key =
+                            prefix ? std::string{ program.prefixes_[prefix - 1] } + util::infix + key : std::move(key);
+                        target.try_emplace(std::move(prefixed_key), std::move(value));
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        std::unreachable();    // top-level TagEnd returns
+    }
+
+    bool is_top_frame() const noexcept { return trail[frame].x == top_call; }
+
+    /**
+     * \return false if there is no match.
+     */
+    bool execute() noexcept
+    {
+        while (true) {
+            if (pc == top_call) {
+                return true;
+            }
+            bool is_ok{ true };
+            auto const& instruction = program.program_[pc];
+            switch (instruction.type) {
+                case Type::Linear:
+                    is_ok = match_linear();
+                    break;
+                case Type::Call:
+                    is_ok = call();
+                    break;
+                case Type::Return:
+                    is_ok = ret();
+                    break;
+                case Type::Split:
+                    if (is_element_run && pc == program.tags_[trail[frame].y].infix_split && is_top_frame()) {
+                        pc = is_last_element ? instruction.y : instruction.x;
+                        break;
+                    }
+                    choices.push_back(snapshot(instruction.y, false));
+                    pc = instruction.x;
+                    break;
+                case Type::Jump:
+                    pc = instruction.x;
+                    break;
+                case Type::Branch:
+                    trail.push_back({ .type = Event::Type::Branch, .x = instruction.x });
+                    ++pc;
+                    break;
+                case Type::ElementBegin:
+                    trail.push_back({ .type = Event::Type::ElementBegin, .begin = pos });
+                    element = trail.size() - 1;
+                    ++pc;
+                    break;
+                case Type::ElementEnd:
+                    is_ok = element_end();
+                    if (is_ok && is_element_run && is_top_frame()) {
+                        if (!is_last_element || pos == subject.size()) {
+                            return true;
+                        }
+                        note_failure(pos);
+                        is_ok = false;
+                    }
+                    break;
+                case Type::Fail:
+                    is_ok = false;
+                    break;
+            }
+            if (!is_ok && !backtrack()) {
+                return false;
+            }
+        }
+    }
+
+    RunResult run(const std::uint32_t tag) noexcept
+    {
+        enter(top_call, tag, npos);
+        if (!execute()) {
+            return std::unexpected{ MatchError{ furthest, std::move(script_error), hit_end } };
+        }
+        return assemble();
+    }
+
+    ElementResult run_element(const std::uint32_t tag, const bool is_last) noexcept
+    {
+        is_element_run = true;
+        is_last_element = is_last;
+        enter(top_call, tag, npos);
+        pc = program.tags_[tag].element_entry;
+        if (!execute()) {
+            return std::unexpected{ MatchError{ furthest, std::move(script_error), hit_end } };
+        }
+        return ElementMatch{ .props = assemble(), .length = pos, .hit_end = hit_end };
+    }
+};
+
+/**
+ * \brief Walks rules of element (and tags called by them) with closings of opened brackets, like split_elements
+ * scans input: element is separable if its input never contains separator outside of brackets.
+ * Character sets of patterns are checked, so it's conservative: e.g. '[^,]+' may be separated by ', ' only
+ * inside of brackets.
+ */
+struct dynser::deserialize::Program::Separation
+{
+    Program const& program;
+    char separator_front;
+
+    // closings after called tag by tag and closings before call, std::nullopt if tag isn't separable (or walked)
+    std::map<std::pair<std::uint32_t, std::string>, std::optional<std::vector<std::string>>> calls{};
+
+    static char closing_of(const char opening) noexcept
+    {
+        switch (opening) {
+            case '(':
+                return ')';
+            case '[':
+                return ']';
+            default:
+                return '}';
+        }
+    }
+
+    /**
+     * \return closings after linear rule, std::nullopt if its input may break split.
+     */
+    std::optional<std::string> after_linear(Linear const& linear, std::string closings) const noexcept
+    {
+        if (!linear.literal) {
+            // pattern with dyn-groups may be anything
+            if (!linear.matcher) {
+                return std::nullopt;
+            }
+            regex::Matcher::CharSet chars;
+            for (auto const& set : linear.matcher->sets()) {
+                chars |= set;
+            }
+            for (const auto ch : std::string_view{ "()[]{}\\" }) {
+                if (chars[static_cast<unsigned char>(ch)]) {
+                    return std::nullopt;
+                }
+            }
+            if (closings.empty() && chars[static_cast<unsigned char>(separator_front)]) {
+                return std::nullopt;
+            }
+            return closings;
+        }
+        for (const auto ch : *linear.literal) {
+            switch (ch) {
+                case '\\':
+                    return std::nullopt;
+                case '(':
+                case '[':
+                case '{':
+                    closings.push_back(closing_of(ch));
+                    break;
+                case ')':
+                case ']':
+                case '}':
+                    if (closings.empty() || closings.back() != ch) {
+                        return std::nullopt;
+                    }
+                    closings.pop_back();
+                    break;
+                default:
+                    if (closings.empty() && ch == separator_front) {
+                        return std::nullopt;
+                    }
+                    break;
+            }
+        }
+        return closings;
+    }
+
+    /**
+     * \return closings at stop (or at return of tag) of every path from pc, std::nullopt if some path isn't separable.
+     */
+    std::optional<std::vector<std::string>>
+    walk(const std::uint32_t pc, std::string closings, const std::uint32_t stop) noexcept
+    {
+        std::vector<std::string> result;
+        std::set<std::pair<std::uint32_t, std::string>> visited;
+        std::vector<std::pair<std::uint32_t, std::string>> pending{ { pc, std::move(closings) } };
+        while (!pending.empty()) {
+            auto [at, state] = std::move(pending.back());
+            pending.pop_back();
+            if (state.size() > max_separation_depth) {
+                return std::nullopt;
+            }
+            if (!visited.emplace(at, state).second) {
+                continue;
+            }
+            if (at == stop) {
+                result.push_back(std::move(state));
+                continue;
+            }
+            auto const& instruction = program.program_[at];
+            switch (instruction.type) {
+                case Type::Linear:
+                {
+                    auto next = after_linear(program.linears_[instruction.x], std::move(state));
+                    if (!next) {
+                        return std::nullopt;
+                    }
+                    pending.emplace_back(at + 1, std::move(*next));
+                    break;
+                }
+                case Type::Call:
+                {
+                    auto const& exits = call(instruction.x, state);
+                    if (!exits) {
+                        return std::nullopt;
+                    }
+                    for (auto const& exit : *exits) {
+                        pending.emplace_back(at + 1, exit);
+                    }
+                    break;
+                }
+                case Type::Return:
+                    result.push_back(std::move(state));
+                    break;
+                case Type::Split:
+                    pending.emplace_back(instruction.y, state);
+                    pending.emplace_back(instruction.x, std::move(state));
+                    break;
+                case Type::Jump:
+                    pending.emplace_back(instruction.x, std::move(state));
+                    break;
+                case Type::Branch:
+                case Type::ElementBegin:
+                case Type::ElementEnd:
+                    pending.emplace_back(at + 1, std::move(state));
+                    break;
+                case Type::Fail:
+                    break;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * \note recursive tag isn't separable (it's walked again before its closings are known).
+     */
+    std::optional<std::vector<std::string>> const& call(const std::uint32_t tag, std::string const& closings) noexcept
+    {
+        const std::pair key{ tag, closings };
+        if (const auto found = calls.find(key); found != calls.end()) {
+            return found->second;
+        }
+        calls.emplace(key, std::nullopt);
+        auto exits = walk(program.tags_[tag].entry, closings, no_pc);
+        return calls[key] = std::move(exits);
+    }
+};
+
+namespace
+{
+
+/**
+ * \brief Every cycle of left recursion consumes something, so its depth is bounded by length of string,
+ * but ambiguous grammar is matched in exponential time of depth: it's increased only if needed.
+ */
+template <typename Run>
+auto run_deepening(Run const& run) noexcept
+{
+    for (auto depth = initial_left_recursion_depth;; depth *= 2) {
+        bool is_depth_exceeded{};
+        auto result = run(depth, is_depth_exceeded);
+        if (result || !is_depth_exceeded) {
+            return result;
+        }
+    }
+}
+
+}    // namespace
+
+dynser::deserialize::Program::Program(config::Config const& config, const MemoOptions memo) noexcept
+  : memo_{ memo }
+{
+    // tags are indexed first: existing rules may refer to tags defined later
+    tags_.reserve(config.tags.size());
+    for (auto const& [name, tag] : config.tags) {
+        tag_indices_.emplace(name, static_cast<std::uint32_t>(tags_.size()));
+        tags_.push_back({ &tag, 0, nullptr, no_pc, no_pc });
+    }
+    Compiler compiler{ *this };
+    for (auto& info : tags_) {
+        compiler.compile(info);
+    }
+}
+
+dynser::deserialize::RunResult dynser::deserialize::Program::run(
+    const std::string_view sv,
+    const std::string_view tag,
+    ResolveDynPattern const& resolve_dyn_pattern,
+    RunScripts const& run_scripts
+) const noexcept
+{
+    return run_deepening([&](const std::size_t depth, bool& is_depth_exceeded) {
+        Executor executor{ .program = *this,
+                           .subject = sv,
+                           .resolve_dyn_pattern = resolve_dyn_pattern,
+                           .run_scripts = run_scripts,
+                           .max_left_recursion_depth = depth };
+        auto result = executor.run(tag_indices_.at(tag));
+        is_depth_exceeded = executor.is_depth_exceeded;
+        return result;
+    });
+}
+
+dynser::deserialize::ElementResult dynser::deserialize::Program::run_element(
+    const std::string_view sv,
+    const std::string_view tag,
+    const bool is_last,
+    ResolveDynPattern const& resolve_dyn_pattern,
+    RunScripts const& run_scripts
+) const noexcept
+{
+    return run_deepening([&](const std::size_t depth, bool& is_depth_exceeded) {
+        Executor executor{ .program = *this,
+                           .subject = sv,
+                           .resolve_dyn_pattern = resolve_dyn_pattern,
+                           .run_scripts = run_scripts,
+                           .max_left_recursion_depth = depth };
+        auto result = executor.run_element(tag_indices_.at(tag), is_last);
+        is_depth_exceeded = executor.is_depth_exceeded;
+        return result;
+    });
+}
+
+bool dynser::deserialize::Program::is_recurrent(const std::string_view tag) const noexcept
+{
+    return tags_[tag_indices_.at(tag)].element_entry != no_pc;
+}
+
+bool dynser::deserialize::Program::has_infix(const std::string_view tag) const noexcept
+{
+    return tags_[tag_indices_.at(tag)].infix_split != no_pc;
+}
+
+std::optional<std::string_view> dynser::deserialize::Program::separator(const std::string_view tag) const noexcept
+{
+    const auto split = tags_[tag_indices_.at(tag)].infix_split;
+    if (split == no_pc) {
+        return std::nullopt;
+    }
+    // I: infix; element-end
+    const auto infix = program_[split].x;
+    if (program_[infix].type != Type::Linear || program_[infix + 1].type != Type::ElementEnd) {
+        return std::nullopt;
+    }
+    return linears_[program_[infix].x].literal;
+}
+
+bool dynser::deserialize::Program::is_separable(const std::string_view tag) const noexcept
+{
+    const auto separator = this->separator(tag);
+    if (!separator || separator->empty()) {
+        return false;
+    }
+    auto const& info = tags_[tag_indices_.at(tag)];
+    Separation separation{ .program = *this, .separator_front = separator->front() };
+    // B: element-begin; rules before infix; split I, N
+    const auto closings = separation.walk(info.element_entry + 1, {}, info.infix_split);
+    return closings && std::ranges::all_of(*closings, &std::string::empty);
+}
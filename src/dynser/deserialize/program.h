@@ -0,0 +1,219 @@
+#pragma once
+
+#include "config/structures.h"
+#include "regex/matcher.h"
+#include "structs/properties.h"
+#include <unordered_map>
+
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dynser::deserialize
+{
+
+/**
+ * \brief Captured value of linear rule field, points into deserialized string (nothing is copied).
+ */
+struct FieldSpan
+{
+    std::string_view name;
+    std::string_view value;
+};
+
+/**
+ * \brief How fields without deserialization script are stored in properties.
+ */
+enum class CaptureMode : std::uint8_t {
+    Copy,    // as strings
+    View,    // as string views into deserialized string, nothing is copied
+};
+
+/**
+ * \brief Fields captured by linear rules of tag (or of one recurrent element) to convert into properties.
+ */
+struct ScriptCall
+{
+    config::yaml::Tag const& tag;
+    std::span<const FieldSpan> fields;
+    std::optional<std::size_t> branch;    // matched branch of branched tag
+};
+
+// error message rejects match (input is backtracked)
+using ScriptResult = std::expected<Properties, std::string>;
+
+/**
+ * \brief Deserialization failure: no way to match whole string.
+ */
+struct MatchError
+{
+    std::size_t position;                       // furthest position where some rule failed
+    std::optional<std::string> script_error;    // set if last failure at that position is a script one
+    bool hit_end{};                             // some rule failed at end of string (longer one may match)
+};
+
+using RunResult = std::expected<Properties, MatchError>;
+
+/**
+ * \brief One element of recurrent tag matched at begin of string.
+ */
+struct ElementMatch
+{
+    Properties props;    // of element itself, not merged into lists
+    std::size_t length;
+    bool hit_end{};    // end of string was reached before match, longer string may be matched differently
+};
+
+using ElementResult = std::expected<ElementMatch, MatchError>;
+
+/**
+ * \brief What is done with memoized tag calls results when memo is full.
+ */
+enum class MemoEviction : std::uint8_t {
+    Lru,        // least recently used results are dropped
+    DropNew,    // new results are not memoized
+};
+
+/**
+ * \brief Memoization of tag calls results by tag and position, memo is per one run.
+ */
+struct MemoOptions
+{
+    std::size_t max_bytes{ 16 << 20 };    // estimated, 0 disables memoization
+    MemoEviction eviction{ MemoEviction::Lru };
+};
+
+/**
+ * \brief Tags of config compiled into one backtracking program over rules (like regex::Matcher over characters).
+ * Linear rules are matched by precompiled regex::Matcher-s, their alternatives are tried on backtrack,
+ * existing rules are calls of other tags. Captures are spans of input, scripts are run on tag (and recurrent
+ * element) end only, so input is read in one forward pass unless some rule fails.
+ * Tag called again at the same position after all its matches were tried (e.g. by other branch) replays
+ * memoized matches instead of matching (and running scripts) again, so tag is matched at most twice at each
+ * position (unless left recursion is cut there or memo is full).
+ * \note config must outlive program.
+ */
+class Program
+{
+public:
+    struct Instruction
+    {
+        enum class Type : std::uint8_t {
+            Linear,          // linear rule linears_[x]
+            Call,            // tag tags_[x], its properties are prefixed with prefixes_[y - 1] (if y is set)
+            Return,          // end of tag, run scripts on own fields
+            Split,           // try x, then y
+            Jump,            // continue from x
+            Branch,          // branch x of branched tag
+            ElementBegin,    // begin of recurrent (or recurrent-dict) element
+            ElementEnd,      // fail on empty element, run scripts on fields of recurrent element (x = 0)
+            Fail,            // existing rule of unknown tag
+        } type;
+        std::uint32_t x{};
+        std::uint32_t y{};
+    };
+
+    /**
+     * \brief Linear rule: literal, precompiled matcher or pattern with dyn-groups (resolved on run).
+     */
+    struct Linear
+    {
+        std::optional<std::string_view> literal;
+        std::optional<regex::Matcher> matcher;
+        config::yaml::DynRegexTemplate const* dyn_pattern{};
+        config::yaml::DynGroupValues const* dyn_groups{};
+        bool with_whole_match_group{};
+        std::vector<std::pair<std::size_t, std::string_view>> fields;    // group number, field name
+    };
+
+    /**
+     * \brief Matcher of linear rule with dyn-groups, nullptr if pattern can't be resolved (rule fails).
+     */
+    using ResolveDynPattern = std::function<regex::Matcher const*(Linear const&)>;
+
+    using RunScripts = std::function<ScriptResult(ScriptCall const&)>;
+
+    explicit Program(config::Config const& config, MemoOptions memo = {}) noexcept;
+
+    [[nodiscard]] bool contains(std::string_view tag) const noexcept { return tag_indices_.contains(tag); }
+
+    /**
+     * \note tag must be in program.
+     */
+    [[nodiscard]] bool is_recurrent(std::string_view tag) const noexcept;
+
+    /**
+     * \note tag must be in program.
+     */
+    [[nodiscard]] bool has_infix(std::string_view tag) const noexcept;
+
+    /**
+     * \brief Literal infix of recurrent tag if it's last rule of element (so elements are separated by it).
+     * \note tag must be in program.
+     */
+    [[nodiscard]] std::optional<std::string_view> separator(std::string_view tag) const noexcept;
+
+    /**
+     * \brief Input of tag element can't contain separator outside of brackets (nor unbalanced brackets or '\'),
+     * so parts of input split by separator (see split_elements) are exactly its elements.
+     * \note tag must be in program.
+     */
+    [[nodiscard]] bool is_separable(std::string_view tag) const noexcept;
+
+    /**
+     * \brief Match whole sv as tag, properties of existing rules are merged into parent ones (with prefix if set),
+     * properties of recurrent elements are merged as lists.
+     * \note tag must be in program.
+     */
+    [[nodiscard]] RunResult run(
+        std::string_view sv,
+        std::string_view tag,
+        ResolveDynPattern const& resolve_dyn_pattern,
+        RunScripts const& run_scripts
+    ) const noexcept;
+
+    /**
+     * \brief Match one element of recurrent tag at begin of sv. Not last element ends with infix
+     * (and rules after it) if tag has infix, otherwise it's first matched prefix of sv. Last element takes whole sv.
+     * \note tag must be recurrent.
+     */
+    [[nodiscard]] ElementResult run_element(
+        std::string_view sv,
+        std::string_view tag,
+        bool is_last,
+        ResolveDynPattern const& resolve_dyn_pattern,
+        RunScripts const& run_scripts
+    ) const noexcept;
+
+    [[nodiscard]] std::vector<Instruction> const& program() const noexcept { return program_; }
+
+    [[nodiscard]] std::vector<Linear> const& linears() const noexcept { return linears_; }
+
+private:
+    struct TagInfo
+    {
+        config::yaml::Tag const* tag;
+        std::uint32_t entry;
+        std::string const* dict_key;    // key of recurrent-dict elements list
+        std::uint32_t element_entry;    // ElementBegin of recurrent tag
+        std::uint32_t infix_split;    // Split between element with infix and last one (if recurrent tag has infix)
+    };
+
+    std::vector<Instruction> program_;
+    std::vector<Linear> linears_;
+    std::vector<TagInfo> tags_;
+    std::vector<std::string_view> prefixes_;
+    std::unordered_map<std::string_view, std::uint32_t> tag_indices_;
+    MemoOptions memo_;
+
+    struct Compiler;
+    struct Executor;
+    struct Separation;
+};
+
+}    // namespace dynser::deserialize
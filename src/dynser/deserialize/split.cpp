@@ -0,0 +1,90 @@
+#include "split.h"
+
+#include "regex/scan.h"
+
+namespace
+{
+
+constexpr std::string_view special_chars = "()[]{}\\";
+
+constexpr char closing_of(const char opening) noexcept
+{
+    switch (opening) {
+        case '(':
+            return ')';
+        case '[':
+            return ']';
+        default:
+            return '}';
+    }
+}
+
+/**
+ * \brief Characters what may change split: first character of separator, brackets and '\'.
+ * '|' is included to make '{|}' one range (and set vectorized), it's just skipped.
+ */
+dynser::regex::SetScanner::CharSet special_set_of(const std::string_view separator) noexcept
+{
+    dynser::regex::SetScanner::CharSet result;
+    for (const auto ch : "()[\\]{|}") {
+        result.set(static_cast<unsigned char>(ch));
+    }
+    result.reset(0);    // terminator of literal
+    result.set(static_cast<unsigned char>(separator.front()));
+    return result;
+}
+
+}    // namespace
+
+std::optional<std::vector<std::string_view>>
+dynser::deserialize::split_elements(const std::string_view sv, const std::string_view separator) noexcept
+{
+    if (separator.empty() || separator.find_first_of(special_chars) != std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    // other characters are skipped by blocks
+    const regex::SetScanner special{ special_set_of(separator) };
+    const auto next_special = [&](const std::size_t from) {
+        return from < sv.size() ? from + special.find(sv.substr(from)) : sv.size();
+    };
+
+    std::vector<std::string_view> result;
+    std::vector<char> closings;    // of opened brackets
+    std::size_t begin{};
+    for (auto pos = next_special(0); pos < sv.size(); pos = next_special(pos)) {
+        const auto ch = sv[pos];
+        if (closings.empty() && ch == separator.front() && sv.substr(pos).starts_with(separator)) {
+            result.push_back(sv.substr(begin, pos - begin));
+            pos += separator.size();
+            begin = pos;
+            continue;
+        }
+        switch (ch) {
+            case '\\':
+                ++pos;    // escaped character
+                break;
+            case '(':
+            case '[':
+            case '{':
+                closings.push_back(closing_of(ch));
+                break;
+            case ')':
+            case ']':
+            case '}':
+                if (closings.empty() || closings.back() != ch) {
+                    return std::nullopt;
+                }
+                closings.pop_back();
+                break;
+            default:
+                break;
+        }
+        ++pos;
+    }
+    if (!closings.empty()) {
+        return std::nullopt;
+    }
+    result.push_back(sv.substr(begin));
+    return result;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace dynser::deserialize
+{
+
+/**
+ * \brief Split sv by separator occurrences outside of brackets ('()', '[]', '{}'), character after '\' is skipped.
+ * \return parts of sv (separators are not included), std::nullopt if brackets are not balanced
+ * or separator is empty or contains brackets or '\' (split would be ambiguous).
+ */
+[[nodiscard]] std::optional<std::vector<std::string_view>>
+split_elements(std::string_view sv, std::string_view separator) noexcept;
+
+}    // namespace dynser::deserialize
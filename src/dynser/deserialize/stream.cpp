@@ -0,0 +1,128 @@
+#include "stream.h"
+
+#include <algorithm>
+
+dynser::deserialize::Stream::Stream(Program const& program, const std::string_view tag, OnElement on_element) noexcept
+  : program_{ &program }
+  , tag_{ tag }
+  , on_element_{ std::move(on_element) }
+  , is_recurrent_{ program.is_recurrent(tag) }
+  , has_infix_{ is_recurrent_ && program.has_infix(tag) }
+  , separator_{ has_infix_ ? program.separator(tag) : std::nullopt }
+{ }
+
+dynser::deserialize::Stream::Result dynser::deserialize::Stream::feed(
+    const std::string_view chunk,
+    Program::ResolveDynPattern const& resolve_dyn_pattern,
+    Program::RunScripts const& run_scripts
+) noexcept
+{
+    if (error_) {
+        return std::unexpected{ *error_ };
+    }
+    buffer_ += chunk;
+    if (!has_infix_) {
+        return {};
+    }
+    return match_elements(false, resolve_dyn_pattern, run_scripts);
+}
+
+dynser::deserialize::Stream::Result dynser::deserialize::Stream::match_elements(
+    const bool is_finished,
+    Program::ResolveDynPattern const& resolve_dyn_pattern,
+    Program::RunScripts const& run_scripts
+) noexcept
+{
+    Result result{};
+    std::size_t matched{};
+    while (matched < buffer_.size()) {
+        const auto rest = std::string_view{ buffer_ }.substr(matched);
+        if (!is_finished && tried_ != 0) {
+            // element ending with literal separator may be completed only by new separator,
+            // other tails are tried again when doubled
+            const auto is_completable =
+                separator_ ? rest.find(*separator_, tried_ - std::min(tried_, separator_->size() - 1)) !=
+                                 std::string_view::npos
+                           : rest.size() >= 2 * tried_;
+            if (!is_completable) {
+                break;
+            }
+        }
+        auto element = program_->run_element(rest, tag_, false, resolve_dyn_pattern, run_scripts);
+        if (is_finished) {
+            // tail without infix is last element
+            if (!element || element->length == rest.size()) {
+                break;
+            }
+        }
+        else if (!element || element->hit_end) {
+            // match may be changed by next chunks (infix may be longer, element may be completed)
+            if (!element && !element.error().hit_end) {
+                element.error().position += matched;
+                result = error_at(std::move(element.error()));
+                error_ = result.error();
+            }
+            tried_ = rest.size();
+            break;
+        }
+        matched += element->length;
+        tried_ = 0;
+        on_element_(std::move(element->props));
+    }
+    buffer_.erase(0, matched);
+    consumed_ += matched;
+    return result;
+}
+
+dynser::deserialize::Stream::Result dynser::deserialize::Stream::finish(
+    Program::ResolveDynPattern const& resolve_dyn_pattern,
+    Program::RunScripts const& run_scripts
+) noexcept
+{
+    if (error_) {
+        return std::unexpected{ *error_ };
+    }
+    if (!is_recurrent_) {
+        auto props = program_->run(buffer_, tag_, resolve_dyn_pattern, run_scripts);
+        if (!props) {
+            return error_at(std::move(props.error()));
+        }
+        on_element_(std::move(*props));
+    }
+    else if (has_infix_) {
+        if (auto matched = match_elements(true, resolve_dyn_pattern, run_scripts); !matched) {
+            return matched;
+        }
+        // infix must be followed by element, so tail is empty only if there are no elements at all
+        if (!buffer_.empty() || consumed_ != 0) {
+            auto element = program_->run_element(buffer_, tag_, true, resolve_dyn_pattern, run_scripts);
+            if (!element) {
+                return error_at(std::move(element.error()));
+            }
+            on_element_(std::move(element->props));
+        }
+    }
+    else {
+        std::size_t matched{};
+        while (matched < buffer_.size()) {
+            auto element = program_->run_element(
+                std::string_view{ buffer_ }.substr(matched), tag_, false, resolve_dyn_pattern, run_scripts
+            );
+            if (!element) {
+                element.error().position += matched;
+                return error_at(std::move(element.error()));
+            }
+            matched += element->length;
+            on_element_(std::move(element->props));
+        }
+    }
+    consumed_ += buffer_.size();
+    buffer_.clear();
+    return {};
+}
+
+dynser::deserialize::Stream::Result dynser::deserialize::Stream::error_at(MatchError&& error) const noexcept
+{
+    error.position += consumed_;
+    return std::unexpected{ std::move(error) };
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "program.h"
+
+#include <cstddef>
+#include <expected>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace dynser::deserialize
+{
+
+/**
+ * \brief Push-style deserialization of recurrent tag: input is fed by chunks, every element is passed
+ * to callback as soon as it (and infix after it) is matched and next chunks can't change the match
+ * (e.g. infix `, *` at the end of fed input may be continued by spaces), so only unmatched tail of input
+ * is buffered. Elements are matched one by one, so element ends on first infix what completes it
+ * (as if whole string is deserialized by lazy elements).
+ * Recurrent tag without infix is matched on finish, not recurrent tag is passed to callback as one element.
+ * \note program must outlive stream.
+ */
+class Stream
+{
+public:
+    using OnElement = std::function<void(Properties&&)>;
+
+    // error position is counted from begin of whole input
+    using Result = std::expected<void, MatchError>;
+
+    /**
+     * \note tag must be in program.
+     */
+    explicit Stream(Program const& program, std::string_view tag, OnElement on_element) noexcept;
+
+    /**
+     * \brief Append chunk and pass completed elements to callback.
+     * Unmatched tail is matched again only if new input may complete it: literal separator is fed
+     * or tail is doubled since last try, so every element is matched amortized constant count of times.
+     * \return error as soon as tail can't be completed by any input, then stream ignores next chunks.
+     */
+    Result feed(
+        std::string_view chunk,
+        Program::ResolveDynPattern const& resolve_dyn_pattern,
+        Program::RunScripts const& run_scripts
+    ) noexcept;
+
+    /**
+     * \brief Match buffered tail as last element (or elements of tag without infix).
+     */
+    [[nodiscard]] Result
+    finish(Program::ResolveDynPattern const& resolve_dyn_pattern, Program::RunScripts const& run_scripts) noexcept;
+
+    /**
+     * \brief Fed input what is not matched yet.
+     */
+    [[nodiscard]] std::string_view buffered() const noexcept { return buffer_; }
+
+    /**
+     * \brief Length of matched input (position of buffered input).
+     */
+    [[nodiscard]] std::size_t consumed() const noexcept { return consumed_; }
+
+private:
+    [[nodiscard]] Result error_at(MatchError&& error) const noexcept;
+
+    /**
+     * \brief Pass not last elements of buffered input to callback, drop them from buffer.
+     * Until finished, elements what may be changed by next chunks are kept.
+     * \return error if not finished and buffered input can't be completed.
+     */
+    Result match_elements(
+        bool is_finished,
+        Program::ResolveDynPattern const& resolve_dyn_pattern,
+        Program::RunScripts const& run_scripts
+    ) noexcept;
+
+    Program const* program_;
+    std::string tag_;
+    OnElement on_element_;
+    std::string buffer_{};
+    std::size_t consumed_{};    // length of input before buffer_
+    std::size_t tried_{};    // length of buffer_ when its element was tried last time (0 if not tried)
+    std::optional<MatchError> error_{};
+    bool is_recurrent_;
+    bool has_infix_;
+    std::optional<std::string_view> separator_;    // literal infix what ends not last element
+};
+
+}    // namespace dynser::deserialize
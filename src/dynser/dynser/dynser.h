@@ -2,15 +2,34 @@
 
 #include "config/config.h"
 #include "config/keywords.h"
+#include "deserialize/program.h"
+#include "deserialize/split.h"
+#include "deserialize/stream.h"
+#include "lua/state_pool.h"
 #include "luwra.hpp"
+#include "parallel/thread_pool.h"
 #include "structs/context.hpp"
 #include "structs/fields.hpp"
+#include "structs/properties_view.h"
+#include "util/layered_map.hpp"
+#include "util/lru_cache.hpp"
 #include "util/prefix.hpp"
 #include "util/visit.hpp"
 #include <unordered_set>
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <concepts>
 #include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
 #include <ranges>
+#include <span>
 #include <sstream>
 #include <string>
 
@@ -147,8 +166,16 @@ struct ConfigTagNotFound
 {
     std::string tag;
 };
+struct NoMatch
+{
+    std::size_t position;    // furthest position where some rule failed
+};
+struct ScriptError
+{
+    std::string message;
+};
 
-using Error = std::variant<Unknown, ConfigNotLoaded, ConfigTagNotFound>;
+using Error = std::variant<Unknown, ConfigNotLoaded, ConfigTagNotFound, NoMatch, ScriptError>;
 
 }    // namespace deserialize_err
 
@@ -178,17 +205,38 @@ struct DeserializeError
 
 using SerializeResult = std::expected<std::string, SerializeError>;
 
+// output is appended to sink
+using SerializeToResult = std::expected<void, SerializeError>;
+
 template <typename Result>
 using DeserializeResult = std::expected<Result, DeserializeError>;
 
 /**
  * \brief helper.
  */
-inline SerializeResult make_serialize_err(serialize_err::Error&& err, Properties scope_props) noexcept
+inline std::unexpected<SerializeError> make_serialize_err(serialize_err::Error&& err, Properties scope_props) noexcept
 {
     return std::unexpected{ SerializeError{ std::move(err), std::move(scope_props), {} } };
 }
 
+/**
+ * \brief helper.
+ */
+inline std::unexpected<SerializeError>
+make_serialize_err(serialize_err::Error&& err, PropertiesView const& scope_props) noexcept
+{
+    return make_serialize_err(std::move(err), scope_props.to_properties());
+}
+
+/**
+ * \brief helper.
+ */
+inline std::unexpected<SerializeError>
+make_serialize_err(serialize_err::Error&& err, OverlaidPropertiesView const& scope_props) noexcept
+{
+    return make_serialize_err(std::move(err), scope_props.to_properties());
+}
+
 /**
  * \brief helper.
  */
@@ -245,6 +293,9 @@ Fields props_to_fields(const Properties& props) noexcept
         if (val.is_string()) {
             result[key] = val.as_const_string();
         }
+        else if (val.is_string_view()) {
+            result[key] = std::string{ val.as_const_string_view() };
+        }
     }
     return result;
 }
@@ -253,12 +304,12 @@ using PrioritizedListLen = std::pair<config::yaml::PriorityType, std::size_t>;
 
 // forward declaration
 std::optional<PrioritizedListLen>
-calc_max_property_lists_len(config::Config const&, Properties const&, config::yaml::Nested const&) noexcept;
+calc_max_property_lists_len(config::Config const&, PropertiesView const&, config::yaml::Nested const&) noexcept;
 
 // for existing and linear rules
 std::optional<PrioritizedListLen> calc_max_property_lists_len_helper(
     config::Config const& config,
-    Properties const& props,
+    PropertiesView const& props,
     config::yaml::LikeExisting auto const& rule
 ) noexcept
 {
@@ -281,7 +332,7 @@ std::optional<PrioritizedListLen> calc_max_property_lists_len_helper(
 // for existing and linear rules (
 std::optional<PrioritizedListLen> calc_max_property_lists_len_helper(
     config::Config const& config,
-    Properties const& props,
+    PropertiesView const& props,
     config::yaml::LikeLinear auto const& rule
 ) noexcept
 {
@@ -326,7 +377,7 @@ std::optional<PrioritizedListLen> calc_max_property_lists_len_helper(
 
 std::optional<PrioritizedListLen> calc_max_property_lists_len(
     config::Config const& config,
-    Properties const& props,
+    PropertiesView const& props,
     config::yaml::Nested const& rules
 ) noexcept
 {
@@ -374,47 +425,335 @@ std::optional<PrioritizedListLen> calc_max_property_lists_len(
     return result;
 }
 
+/**
+ * \brief Approximate length of pattern output without groups: escaped characters and character classes
+ * are one character, quantifiers and groups are skipped.
+ */
+std::size_t estimate_pattern_literal_size(std::string_view pattern) noexcept
+{
+    std::size_t result{};
+    std::size_t depth{};
+    for (std::size_t pos{}; pos < pattern.size(); ++pos) {
+        const auto c = pattern[pos];
+        if (c == '\\') {
+            ++pos;
+            result += depth == 0;
+        }
+        else if (c == '[') {
+            // ']' right after '[' (or '[^') is a character
+            pos = pattern.find(']', pos + (pattern.substr(pos).starts_with("[^") ? 3 : 2));
+            if (pos == std::string_view::npos) {
+                break;
+            }
+            result += depth == 0;
+        }
+        else if (c == '(') {
+            ++depth;
+        }
+        else if (c == ')') {
+            depth -= depth != 0;
+        }
+        else if (c == '{') {
+            pos = std::min(pattern.find('}', pos), pattern.size());
+        }
+        else if (depth == 0 && c != '?' && c != '*' && c != '+' && c != '|' && c != '^' && c != '$') {
+            ++result;
+        }
+    }
+    return result;
+}
+
+/**
+ * \brief Approximate length of serialized property value, average element length for lists.
+ */
+std::size_t estimate_value_size(PropertyValue const& value) noexcept
+{
+    if (value.is_string()) {
+        return value.as_const_string().size();
+    }
+    if (value.is_string_view()) {
+        return value.as_const_string_view().size();
+    }
+    if (value.is_list()) {
+        auto const& list = value.as_const_list();
+        std::size_t total{};
+        for (auto const& element : list) {
+            total += estimate_value_size(element);
+        }
+        return list.empty() ? 0 : total / list.size();
+    }
+    const auto integer_size = [](const auto integer) {
+        char buffer[24];
+        return static_cast<std::size_t>(std::to_chars(buffer, std::end(buffer), integer).ptr - buffer);
+    };
+    if (value.is_i32()) {
+        return integer_size(value.as_const_i32());
+    }
+    if (value.is_i64()) {
+        return integer_size(value.as_const_i64());
+    }
+    if (value.is_u32()) {
+        return integer_size(value.as_const_u32());
+    }
+    if (value.is_u64()) {
+        return integer_size(value.as_const_u64());
+    }
+    if (value.is_float()) {
+        return 8;
+    }
+    if (value.is_bool()) {
+        return 5;
+    }
+    return value.is_char() ? 1 : 0;
+}
+
+/**
+ * \brief Approximate output length of tag, used to reserve output buffer once.
+ * Literal rules give exact length, other linear rules give length of pattern literal part and of properties
+ * named as their fields (average element of lists), recurrent rules are multiplied by lists length.
+ * Existing rules get scoped properties as in serialization. Recursive tags are counted once.
+ */
+std::size_t estimate_output_size(
+    config::Config const& config,
+    PropertiesView const& props,
+    std::string const& tag,
+    std::unordered_set<std::string>& visiting
+) noexcept
+{
+    using namespace config::yaml;
+
+    if (!config.tags.contains(tag) || visiting.contains(tag)) {
+        return 0;
+    }
+    visiting.insert(tag);
+
+    const auto estimate_rule = [&](auto const& rule) noexcept -> std::size_t {
+        if constexpr (LikeExisting<decltype(rule)>) {
+            const auto scoped = props.scoped(
+                rule.prefix ? std::optional<std::string_view>{ *rule.prefix } : std::nullopt, rule.tag
+            );
+            return estimate_output_size(config, scoped, rule.tag, visiting);
+        }
+        else {
+            if (rule.literal) {
+                return rule.literal->size();
+            }
+            auto result = estimate_pattern_literal_size(rule.pattern);
+            if (rule.fields) {
+                for (auto const& [group, field] : *rule.fields) {
+                    if (auto const* const value = props.find(field)) {
+                        result += estimate_value_size(*value);
+                    }
+                }
+            }
+            return result;
+        }
+    };
+    const auto estimate_rules = [&](auto const& rules) noexcept {
+        std::size_t result{};
+        for (auto const& rule : rules) {
+            result += std::visit(estimate_rule, rule);
+        }
+        return result;
+    };
+
+    auto const& nested = config.tags.at(tag).nested;
+    const auto result = util::visit_one_terminated(
+        nested,
+        [&](Continual const& continual) noexcept { return estimate_rules(continual); },
+        [&](Branched const& branched) noexcept {
+            // longest branch
+            std::size_t max_size{};
+            for (auto const& rule : branched.rules) {
+                max_size = std::max(max_size, std::visit(estimate_rule, rule));
+            }
+            return max_size;
+        },
+        [&](Recurrent const& recurrent) noexcept {
+            const auto lists_len = calc_max_property_lists_len(config, props, nested);
+            return lists_len ? lists_len->second * estimate_rules(recurrent) : 0;
+        },
+        [&](RecurrentDict const& recurrent_dict) noexcept -> std::size_t {
+            const auto* const dicts = props.find(recurrent_dict.key);
+            if (!dicts || !dicts->is_list()) {
+                return 0;
+            }
+            // dicts of one list have similar sizes
+            auto const& list = dicts->as_const_list();
+            if (list.empty() || !list.front().is_map()) {
+                return 0;
+            }
+            const PropertiesView first{ list.front().as_const_map() };
+            return list.size() * estimate_output_size(config, first, recurrent_dict.tag, visiting);
+        }
+    );
+
+    visiting.erase(tag);
+    return result;
+}
+
+/**
+ * \brief Pattern after dyn-groups substitution, key of parsed patterns cache.
+ */
+struct DynPatternKey
+{
+    config::yaml::Regex pattern;
+    bool with_whole_match_group;
+
+    bool operator==(DynPatternKey const&) const noexcept = default;
+};
+
+struct DynPatternKeyHash
+{
+    std::size_t operator()(DynPatternKey const& key) const noexcept
+    {
+        return std::hash<std::string>{}(key.pattern) ^ static_cast<std::size_t>(key.with_whole_match_group);
+    }
+};
+
+// distinct dyn-groups values are few in practice (e.g. field widths)
+inline constexpr std::size_t dyn_patterns_cache_capacity = 64;
+
+// shorter recurrent-dicts are serialized sequentially, session setup costs more than they gain
+inline constexpr std::size_t min_parallel_recurrent_dict_len = 1024;
+
+// elements serialized by one session
+inline constexpr std::size_t min_parallel_chunk_len = 64;
+
+// records of parallel batch serialized by one session
+inline constexpr std::size_t min_parallel_batch_chunk_len = 16;
+
+// shorter input is deserialized sequentially, split scan and sessions setup cost more than they gain
+inline constexpr std::size_t min_parallel_deserialize_len = 64 * 1024;
+
+// part of input after failure position copied to deserialize error
+inline constexpr std::size_t deserialize_err_scope_len = 64;
+
+// fragments passed to stream or callback sink (so only one fragment is kept in memory)
+inline constexpr std::size_t sink_fragment_size = 4 * 1024;
+
 }    // namespace details
 
 /**
- * \brief string <=> target convertion based on Mappers and config file.
- * \tparam PropertyToTargetMapper functor what receives properties struct (and context) and returns target.
- * \tparam TargetToPropertyMapper functor what receives target (and context) and returns properties struct.
+ * \brief Output of serialize_to besides std::string: stream or callback receiving std::string_view.
  */
-template <typename PropertyToTargetMapper, typename TargetToPropertyMapper>
-class DynSer
+template <typename Sink>
+concept SerializeSink = std::derived_from<Sink, std::ostream> || std::invocable<Sink&, std::string_view>;
+
+/**
+ * \brief Serialized records of batch in one contiguous buffer.
+ */
+struct SerializedBatch
 {
-    std::optional<config::Config> config_{};
+    std::string buffer{};
+    // i-th record is buffer[offsets[i], offsets[i + 1])
+    std::vector<std::size_t> offsets{ 0 };
 
-    config::ParseResult from_file(const config::RawContents& wrapper) noexcept
+    [[nodiscard]] std::size_t size() const noexcept { return offsets.size() - 1; }
+
+    [[nodiscard]] std::string_view operator[](const std::size_t ind) const noexcept
     {
-        return config::from_string(wrapper.config);
+        return std::string_view{ buffer }.substr(offsets[ind], offsets[ind + 1] - offsets[ind]);
     }
 
-    config::ParseResult from_file(const config::FileName& wrapper) noexcept
+    void clear() noexcept
     {
-        std::ifstream file{ wrapper.config_file_name };
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        return from_file(config::RawContents(buffer.str()));
+        buffer.clear();
+        offsets.assign(1, 0);
+    }
+};
+
+using SerializeBatchResult = std::expected<SerializedBatch, SerializeError>;
+
+/**
+ * \brief Serialization and deserialization of properties by shared config, without mappers.
+ * Owns lua states and caches only, config and deserialization program are shared, context is owner's one.
+ * \note session must be used by one thread at a time, owner (DynSer) must outlive it.
+ */
+class Session
+{
+protected:
+    // shared with sessions, never modified after load (merge makes a copy)
+    std::shared_ptr<const config::CompiledConfig> config_{};
+
+    // reused between (nested) serialize calls, not shared with sessions
+    lua::StatePool lua_states_{};
+
+    // parsed patterns of rules with dyn-groups
+    util::LruCache<details::DynPatternKey, regex::ParseResult, details::DynPatternKeyHash> dyn_patterns_{
+        details::dyn_patterns_cache_capacity
+    };
+
+    // compiled on first deserialization, shared with sessions (config_ must outlive it)
+    std::shared_ptr<const deserialize::Program> deserialize_program_{};
+    deserialize::MemoOptions deserialize_memo_{};
+
+    // matchers of rules with dyn-groups, std::nullopt if resolved pattern is invalid
+    util::LruCache<details::DynPatternKey, std::optional<regex::Matcher>, details::DynPatternKeyHash> dyn_matchers_{
+        details::dyn_patterns_cache_capacity
+    };
+
+    // opt-in parallel serialization of recurrent-dict elements (and deserialization of recurrent lists),
+    // not passed to sessions (they are run by pool already)
+    std::shared_ptr<parallel::ThreadPool> thread_pool_{};
+    std::size_t min_parallel_len_{ details::min_parallel_recurrent_dict_len };
+
+    // not copied, owner (DynSer) binds its own context
+    Context const* context_{};
+
+private:
+    /**
+     * \brief Output of serialize_props_chunked call: out is passed to sink at rule boundaries.
+     * Passed down by nested serialize calls of this call only, nullptr if output is not chunked.
+     */
+    struct ChunkedOutput
+    {
+        std::function<void(std::string_view)> sink;
+        std::size_t chunk_size;
+        std::size_t flushed_count{};    // count of flushes, to detect flush inside nested call
+        std::size_t no_flush_depth{};    // output of optional existing rules may be dropped, so it is not flushed
+    };
+
+    /**
+     * \brief Pass out to chunk sink if it is long enough and may not be dropped anymore.
+     */
+    static void try_flush(std::string& out, ChunkedOutput* const chunked) noexcept
+    {
+        if (chunked && chunked->no_flush_depth == 0 && out.size() >= chunked->chunk_size) {
+            chunked->sink(std::string_view{ out });
+            ++chunked->flushed_count;
+            out.clear();
+        }
     }
 
     // share 'existing' serialize between continual, branched and recurrent
     template <typename Existing>
-    auto gen_existing_process_helper(const auto& props, const auto& after_script_fields) noexcept
+    auto gen_existing_process_helper(
+        std::string& out,
+        const auto& props,
+        const auto& after_script_fields,
+        ChunkedOutput* const chunked
+    ) noexcept
     {
-        return [&](const Existing& nested) noexcept -> dynser::SerializeResult {
-            // remove prefix if exists
-            const auto without_prefix = nested.prefix ? util::remove_prefix(props, *nested.prefix) : props;
-            // replace parent props with child (existing) props
+        return [&, chunked](const Existing& nested) noexcept -> dynser::SerializeToResult {
+            // remove prefix if exists, then replace parent props with child (existing) props
             // FIXME not obvious behavior, must be documented at least
-            const auto inp = util::remove_prefix(without_prefix, nested.tag) << without_prefix;
-            const auto serialize_result = this->serialize_props(inp, nested.tag);
+            const auto inp = props.scoped(
+                nested.prefix ? std::optional<std::string_view>{ *nested.prefix } : std::nullopt, nested.tag
+            );
+            // partial output is dropped on error
+            if (chunked && !nested.required) {
+                ++chunked->no_flush_depth;
+            }
+            const auto serialize_result = this->serialize_props_to(out, inp, nested.tag, chunked);
+            if (chunked && !nested.required) {
+                --chunked->no_flush_depth;
+            }
             if (!serialize_result &&
                 std::holds_alternative<serialize_err::ScriptVariableNotFound>(serialize_result.error().error) &&
                 !nested.required)
             {
-                return "";    // can be used as recursion exit
+                return {};    // can be used as recursion exit
             }
 
             return serialize_result;    // pass through
@@ -423,18 +762,15 @@ class DynSer
 
     // share 'linear' serialize between continual, branched and recurrent
     template <typename Linear>
-    auto gen_linear_process_helper(const auto& props, const auto& after_script_fields) noexcept
+    auto gen_linear_process_helper(std::string& out, const auto& props, const auto& after_script_fields) noexcept
     {
-        return [&](const Linear& nested) noexcept -> dynser::SerializeResult {
+        return [&](const Linear& nested) noexcept -> dynser::SerializeToResult {
             using config::yaml::GroupValues;
 
-            const auto pattern =
-                nested.dyn_groups
-                    ? config::details::resolve_dyn_regex(
-                          nested.pattern,
-                          *dynser::details::merge_maps(*nested.dyn_groups, dynser::details::props_to_fields(context))
-                      )
-                    : nested.pattern;
+            if (nested.literal) {
+                out += *nested.literal;
+                return {};
+            }
             const auto regex_fields_sus = nested.fields
                                               ? dynser::details::merge_maps(*nested.fields, after_script_fields)
                                               : std::expected<GroupValues, std::string>{ GroupValues{} };
@@ -442,181 +778,541 @@ class DynSer
                 // failed to merge script variables (script not set all variables or failed to execute)
                 return make_serialize_err(serialize_err::ScriptVariableNotFound{ regex_fields_sus.error() }, props);
             }
-            const auto to_string_result = config::details::resolve_regex(pattern, *regex_fields_sus);
+            // pattern without dyn-groups is parsed on config load
+            const auto to_string_result = [&] {
+                if (nested.compiled_pattern) {
+                    return config::details::resolve_regex(*nested.compiled_pattern, *regex_fields_sus);
+                }
+                const auto dyn_group_values =
+                    dynser::details::merge_maps(*nested.dyn_groups, dynser::details::props_to_fields(*context_));
+                details::DynPatternKey key{
+                    .pattern = config::details::resolve_dyn_regex(*nested.dyn_pattern, *dyn_group_values),
+                    .with_whole_match_group = regex_fields_sus->contains(0),
+                };
+                if (const auto* const cached = dyn_patterns_.find(key)) {
+                    return config::details::resolve_regex(*cached, *regex_fields_sus);
+                }
+                auto compiled = config::details::compile_regex(key.pattern, key.with_whole_match_group);
+                return config::details::resolve_regex(
+                    dyn_patterns_.insert(key, std::move(compiled)), *regex_fields_sus
+                );
+            }();
 
             if (!to_string_result) {
                 return make_serialize_err(serialize_err::ResolveRegexError{ to_string_result.error() }, props);
             }
-            return *to_string_result;
+            out += *to_string_result;
+            return {};
         };
     }
 
+    Session(
+        std::shared_ptr<const config::CompiledConfig> config,
+        std::shared_ptr<const deserialize::Program> deserialize_program,
+        const deserialize::MemoOptions deserialize_memo,
+        Context const& context
+    ) noexcept
+      : config_{ std::move(config) }
+      , deserialize_program_{ std::move(deserialize_program) }
+      , deserialize_memo_{ deserialize_memo }
+      , context_{ &context }
+    { }
+
+protected:
+    Session() noexcept = default;
+
+    void bind_context(Context const& context) noexcept { context_ = &context; }
+
 public:
-    const PropertyToTargetMapper pttm;
-    const TargetToPropertyMapper ttpm;
-    Context context;
+    /**
+     * \brief Loaded config to share with other instances, nullptr if config not loaded.
+     */
+    [[nodiscard]] std::shared_ptr<const config::CompiledConfig> shared_config() const noexcept { return config_; }
+
+    /**
+     * \brief Session for another thread: config and compiled program are shared, context is read from owner,
+     * lua states and caches are own (and empty), thread pool is not used.
+     * \note sessions may serialize concurrently, but each one must be used by one thread at a time.
+     */
+    [[nodiscard]] Session session() const noexcept
+    {
+        return Session{ config_, deserialize_program_, deserialize_memo_, *context_ };
+    }
 
-    DynSer() noexcept
-      : pttm{ generate_property_to_target_mapper() }
-      , ttpm{ generate_target_to_property_mapper() }
-    { }
+    SerializeResult serialize_props(const Properties& props, const std::string_view tag) noexcept
+    {
+        return serialize_props(PropertiesView{ props }, tag);
+    }
 
-    DynSer(PropertyToTargetMapper&& pttm, TargetToPropertyMapper&& ttpm) noexcept
-      : pttm{ std::move(pttm) }
-      , ttpm{ std::move(ttpm) }
-    { }
+    SerializeResult serialize_props(const PropertiesView& props, const std::string_view tag) noexcept
+    {
+        std::string result;
+        reserve_output(result, props, tag);
+        if (auto serialize_result = serialize_props_to(result, props, tag); !serialize_result) {
+            return std::unexpected{ std::move(serialize_result.error()) };
+        }
+        return result;
+    }
 
-    template <typename ConfigWrapper>
-    config::ParseResult load_config(ConfigWrapper&& wrapper) noexcept
+    SerializeToResult serialize_props_to(std::string& out, const Properties& props, const std::string_view tag) noexcept
     {
-        auto config = from_file(std::forward<ConfigWrapper>(wrapper));
-        if (config) {
-            config_ = std::move(*config);
+        const PropertiesView view{ props };
+        reserve_output(out, view, tag);
+        return serialize_props_to(out, view, tag);
+    }
+
+    /**
+     * \brief Append serialized properties to out, out is left unchanged on error.
+     * Existing rules receive scoped views of props and append to the same out (nothing is copied).
+     */
+    SerializeToResult
+    serialize_props_to(std::string& out, const PropertiesView& props, const std::string_view tag) noexcept
+    {
+        return serialize_props_to(out, props, tag, nullptr);
+    }
+
+    /**
+     * \brief Pass serialized properties to stream or callback in fragments as soon as rules are serialized
+     * (see serialize_props_chunked), whole output is never kept in memory.
+     * \note on error fragments already passed are not revoked, whole output must be discarded.
+     */
+    template <SerializeSink Sink>
+    SerializeToResult serialize_props_to(Sink& sink, const Properties& props, const std::string_view tag) noexcept
+    {
+        return serialize_props_chunked(props, tag, details::sink_fragment_size, sink);
+    }
+
+    /**
+     * \brief Append serialized records to out, out is left unchanged on error.
+     * Tag is resolved and lua state is acquired once for the whole batch.
+     * Error has ref to failed record: { tag, record index }.
+     */
+    SerializeToResult serialize_batch(
+        const std::span<const Properties> batch,
+        const std::string_view tag,
+        SerializedBatch& out
+    ) noexcept
+    {
+        return serialize_batch_impl(
+            batch, [](const Properties& props) noexcept -> const Properties& { return props; }, tag, out
+        );
+    }
+
+    SerializeBatchResult serialize_batch(const std::span<const Properties> batch, const std::string_view tag) noexcept
+    {
+        SerializedBatch result;
+        if (auto serialize_result = serialize_batch(batch, tag, result); !serialize_result) {
+            return std::unexpected{ std::move(serialize_result.error()) };
         }
-        return config;
+        return result;
     }
 
-    template <typename ConfigWrapper>
-    config::ParseResult merge_config(ConfigWrapper&& wrapper) noexcept
+    /**
+     * \brief Pass each serialized record to stream (one after another) or callback (one call per record)
+     * as soon as it is serialized, only current record is kept in memory.
+     * \note on error records before failed one are already passed.
+     */
+    template <SerializeSink Sink>
+    SerializeToResult
+    serialize_batch(const std::span<const Properties> batch, const std::string_view tag, Sink& sink) noexcept
     {
-        auto config = from_file(std::forward<ConfigWrapper>(wrapper));
-        if (config) {
-            config_->merge(std::move(*config));
+        std::string buffer;
+        return serialize_batch_impl(
+            batch,
+            [](const Properties& props) noexcept -> const Properties& { return props; },
+            tag,
+            buffer,
+            1,
+            [&] {
+                write_to_sink(sink, buffer);
+                buffer.clear();
+            }
+        );
+    }
+
+    /**
+     * \brief Serialize records on thread pool (see set_thread_pool), sequentially if it is not set.
+     * Each chunk of records is serialized by own session (own lua states and buffers),
+     * failed record doesn't stop others.
+     * \note context must not be modified until call returns, each chunk reads its own copy of it.
+     * \return results in order of records.
+     */
+    std::vector<SerializeResult>
+    serialize_batch_parallel(const std::span<const Properties> batch, const std::string_view tag) noexcept
+    {
+        return serialize_batch_parallel_impl(
+            batch.size(),
+            [&](Session& session, Context&, const std::size_t ind) noexcept {
+                return session.serialize_props(batch[ind], tag);
+            }
+        );
+    }
+
+    /**
+     * \brief Pass serialized properties to stream or callback in chunks, as soon as rules are serialized.
+     * Chunk is passed when output of completed rule (or recurrent element) reaches chunk_size,
+     * so only current chunk (and output of rule in progress) is kept in memory.
+     * \note on error chunks already passed are not revoked, whole output must be discarded.
+     */
+    template <SerializeSink Sink>
+    SerializeToResult serialize_props_chunked(
+        const Properties& props,
+        const std::string_view tag,
+        const std::size_t chunk_size,
+        Sink& sink
+    ) noexcept
+    {
+        ChunkedOutput chunked{ [&sink](const std::string_view chunk) { write_to_sink(sink, chunk); }, chunk_size };
+        std::string buffer;
+        buffer.reserve(chunk_size);
+
+        auto result = serialize_props_impl(buffer, PropertiesView{ props }, tag, &chunked);
+        if (result && !buffer.empty()) {
+            chunked.sink(std::string_view{ buffer });
         }
-        return config;
+        return result;
     }
 
-    SerializeResult serialize_props(const Properties& props, const std::string_view tag) noexcept
+protected:
+    /**
+     * \brief Shared by parallel batch overloads, serialize_one serializes ind-th record by given session.
+     * Session of chunk reads chunk copy of context, it is passed to serialize_one for mappers.
+     */
+    template <typename SerializeOne>
+    std::vector<SerializeResult>
+    serialize_batch_parallel_impl(const std::size_t count, const SerializeOne& serialize_one) noexcept
+    {
+        std::vector<SerializeResult> results(count);
+        const auto serialize_chunk = [&](const std::size_t begin, const std::size_t end) noexcept {
+            // mappers receive mutable context, so chunks don't share owner's one
+            Context chunk_context{ *context_ };
+            Session chunk_session{ config_, deserialize_program_, deserialize_memo_, chunk_context };
+            for (auto ind = begin; ind < end; ++ind) {
+                results[ind] = serialize_one(chunk_session, chunk_context, ind);
+            }
+        };
+        if (thread_pool_) {
+            thread_pool_->for_each_chunk(count, details::min_parallel_batch_chunk_len, serialize_chunk);
+        }
+        else {
+            serialize_chunk(0, count);
+        }
+        return results;
+    }
+
+    /**
+     * \brief Append records of batch to out, SerializedBatch is left unchanged on error.
+     */
+    template <typename Record, typename ToProps>
+    SerializeToResult serialize_batch_impl(
+        const std::span<const Record> batch,
+        const ToProps& to_props,
+        const std::string_view tag,
+        SerializedBatch& out
+    ) noexcept
+    {
+        const auto buffer_size = out.buffer.size();
+        const auto offsets_size = out.offsets.size();
+        out.offsets.reserve(offsets_size + batch.size());
+
+        auto result = serialize_batch_impl(batch, to_props, tag, out.buffer, batch.size(), [&out] {
+            out.offsets.push_back(out.buffer.size());
+        });
+        if (!result) {
+            out.buffer.resize(buffer_size);
+            out.offsets.resize(offsets_size);
+        }
+        return result;
+    }
+
+    /**
+     * \brief Shared by batch overloads, to_props maps record to Properties (or reference to them).
+     * on_record is called after each record is appended to out (and may consume it), out is reserved
+     * for reserved_records records. Output of failed record is left in out.
+     */
+    template <typename Record, typename ToProps, typename OnRecord>
+    SerializeToResult serialize_batch_impl(
+        const std::span<const Record> batch,
+        const ToProps& to_props,
+        const std::string_view tag,
+        std::string& out,
+        const std::size_t reserved_records,
+        const OnRecord& on_record
+    ) noexcept
+    {
+        if (!config_) {
+            return make_serialize_err(serialize_err::ConfigNotLoaded{}, Properties{});
+        }
+        const auto tag_config = config_->tags.find(std::string{ tag });
+        if (tag_config == config_->tags.end()) {
+            return make_serialize_err(serialize_err::ConfigTagNotFound{ std::string{ tag } }, Properties{});
+        }
+
+        auto state_handle = lua_states_.acquire();
+        (*state_handle)[config::keywords::CONTEXT] = *context_;
+
+        for (std::size_t ind{}; ind < batch.size(); ++ind) {
+            decltype(auto) props = to_props(batch[ind]);
+            const PropertiesView view{ props };
+            if (ind == 0) {
+                // records of same tag have similar sizes
+                std::unordered_set<std::string> visiting;
+                out.reserve(
+                    out.size() +
+                    reserved_records * details::estimate_output_size(*config_, view, tag_config->first, visiting)
+                );
+            }
+
+            auto result = serialize_tag(out, view, tag, tag_config->second, state_handle, nullptr);
+            if (!result) {
+                append_ref_to_err(result.error(), { std::string{ tag }, ind });
+                return result;
+            }
+            on_record();
+        }
+        return {};
+    }
+
+private:
+    /**
+     * \brief Reserve estimated output size (only on top level, nested calls append to reserved buffer).
+     */
+    void reserve_output(std::string& out, const PropertiesView& props, const std::string_view tag) const noexcept
+    {
+        if (!config_) {
+            return;
+        }
+        std::unordered_set<std::string> visiting;
+        out.reserve(out.size() + details::estimate_output_size(*config_, props, std::string{ tag }, visiting));
+    }
+
+    /**
+     * \brief Same as public serialize_props_to, output is passed to chunked sink (if set) at rule boundaries.
+     */
+    SerializeToResult serialize_props_to(
+        std::string& out,
+        const PropertiesView& props,
+        const std::string_view tag,
+        ChunkedOutput* const chunked
+    ) noexcept
+    {
+        const auto out_size = out.size();
+        const auto flushed_count = chunked ? chunked->flushed_count : 0;
+        auto result = serialize_props_impl(out, props, tag, chunked);
+        if (!result) {
+            // flushed output can't be dropped, error is passed to the top anyway
+            if (chunked && chunked->flushed_count != flushed_count) {
+                out.clear();
+            }
+            else {
+                out.resize(out_size);
+            }
+        }
+        return result;
+    }
+
+    SerializeToResult serialize_props_impl(
+        std::string& out,
+        const PropertiesView& props,
+        const std::string_view tag,
+        ChunkedOutput* const chunked
+    ) noexcept
     {
         if (!config_) {
             return make_serialize_err(serialize_err::ConfigNotLoaded{}, props);
         }
-        if (!config_->tags.contains(std::string{ tag })) {
+        const auto tag_config = config_->tags.find(std::string{ tag });
+        if (tag_config == config_->tags.end()) {
             return make_serialize_err(serialize_err::ConfigTagNotFound{ std::string{ tag } }, props);
         }
 
-        using namespace config::yaml;
-        using namespace config;
+        auto state_handle = lua_states_.acquire();
+        (*state_handle)[config::keywords::CONTEXT] = *context_;
 
-        // input: { 'a': 0, 'b': [ 1, 2, 3 ] }
-        // output: ( { 'a': 0 }, [ { 'b': 1 }, { 'b': 2 }, { 'b': 3 } ] )
-        dynser::Properties non_list_props;
-        std::vector<dynser::Properties> unflattened_props_vector;
-        std::tie(non_list_props, unflattened_props_vector) =
-            [](Properties const& props) -> std::pair<Properties, std::vector<Properties>> {    // iife
-            std::vector<Properties> unflattened_props;
-            Properties non_list_props;
-
-            for (auto const& [key, prop_val] : props) {
-                if (prop_val.is_list()) {
-                    const auto size = prop_val.as_const_list().size();
-
-                    if (unflattened_props.size() < size) {
-                        unflattened_props.resize(size);
-                    }
-                    for (std::size_t ind{}; auto const& el : prop_val.as_const_list()) {
-                        unflattened_props[ind][key] = el;
-                        ++ind;
+        return serialize_tag(out, props, tag, tag_config->second, state_handle, chunked);
+    }
+
+    template <SerializeSink Sink>
+    static void write_to_sink(Sink& sink, const std::string_view fragment) noexcept
+    {
+        if constexpr (std::derived_from<Sink, std::ostream>) {
+            sink.write(fragment.data(), static_cast<std::streamsize>(fragment.size()));
+        }
+        else {
+            sink(fragment);
+        }
+    }
+
+    /**
+     * \brief Each chunk of dicts is serialized by own session into own buffer, buffers are appended in order.
+     * Finished chunk is appended (and flushed to chunked sink) as soon as all chunks before it are appended,
+     * so only chunks finished out of order are kept. Sink is called by pool threads, one call at a time.
+     * Elements after failed one are skipped, error of first failed element is returned (as in sequential loop).
+     */
+    SerializeToResult serialize_recurrent_dict_parallel(
+        std::string& out,
+        const PropertyValue::ListType<PropertyValue>& dicts,
+        const std::string& dict_tag,
+        const std::string_view tag,
+        ChunkedOutput* const chunked
+    ) noexcept
+    {
+        struct ChunkResult
+        {
+            std::size_t end;
+            std::string out;
+            std::optional<std::pair<std::size_t, SerializeError>> error;    // element index and its error
+        };
+
+        std::atomic<std::size_t> first_failed{ dicts.size() };
+        std::mutex results_mutex;
+        // guarded by results_mutex: chunks finished before previous ones (by begin) and begin of next chunk to append
+        std::map<std::size_t, ChunkResult> pending;
+        std::size_t next_begin{};
+        std::optional<std::pair<std::size_t, SerializeError>> error;
+
+        thread_pool_->for_each_chunk(
+            dicts.size(),
+            details::min_parallel_chunk_len,
+            [&](const std::size_t begin, const std::size_t end) noexcept {
+                auto chunk_session = session();
+                ChunkResult result{ .end = end, .out = {}, .error = std::nullopt };
+                for (auto ind = begin; ind < end && ind < first_failed.load(); ++ind) {
+                    auto serialize_result = chunk_session.serialize_props_to(
+                        result.out, PropertiesView{ dicts[ind].as_const_map() }, dict_tag
+                    );
+                    if (!serialize_result) {
+                        result.error.emplace(ind, std::move(serialize_result.error()));
+                        auto failed = first_failed.load();
+                        while (ind < failed && !first_failed.compare_exchange_weak(failed, ind)) { }
+                        break;
                     }
                 }
-                else {
-                    non_list_props[key] = prop_val;
+                std::lock_guard lock{ results_mutex };
+                pending.emplace(begin, std::move(result));
+                // chunks before first failed one are complete
+                for (auto next = pending.find(next_begin); !error && next != pending.end();
+                     next = pending.find(next_begin))
+                {
+                    auto& next_result = next->second;
+                    if (next_result.error) {
+                        error = std::move(next_result.error);
+                    }
+                    else {
+                        out += next_result.out;
+                        try_flush(out, chunked);
+                        next_begin = next_result.end;
+                    }
+                    pending.erase(next);
                 }
             }
+        );
+
+        if (error) {
+            append_ref_to_err(error->second, { std::string{ tag }, error->first });
+            return std::unexpected{ std::move(error->second) };
+        }
+        return {};
+    }
+
+    /**
+     * \brief Serialize props with already found tag config in acquired state (with 'ctx' set).
+     * chunked is output of serialize_props_chunked call (nullptr if output is not chunked).
+     */
+    SerializeToResult serialize_tag(
+        std::string& out,
+        const PropertiesView& props,
+        const std::string_view tag,
+        const config::yaml::Tag& tag_config,
+        lua::StatePool::Handle& state_handle,
+        ChunkedOutput* const chunked
+    ) noexcept
+    {
+        using namespace config::yaml;
+        using namespace config;
 
-            return { non_list_props, unflattened_props };
-        }(props);
+        // input: { 'a': 0, 'b': [ 1, 2, 3 ] }
+        // output: { 'a': 0 }, list elements are viewed on demand (by recurrent rules only)
+        const auto non_list_props = props.non_lists();
 
-        luwra::StateWrapper state;
-        state.loadStandardLibrary();
-        register_userdata_property_value(state);
-        state[keywords::CONTEXT] = context;
-        const auto& tag_config = config_->tags.at(std::string{ tag });
+        auto& state = *state_handle;
 
+        // output is cleared and refilled, so one buffer is reused for all list elements
         const auto props_to_fields =    //
-            [](luwra::StateWrapper& state, Properties const& props, Tag const& tag_config
-            ) -> std::expected<dynser::Fields, dynser::SerializeError> {
-            state[keywords::INPUT_TABLE] = props;
-            state[keywords::OUTPUT_TABLE] = Fields{};
-            // run script
-            if (const auto& script = tag_config.serialization_script) {
-                const auto script_run_result = state.runString(script->c_str());
+            [](lua::StatePool::Handle& handle,
+               PropertiesView const& element_props,
+               Tag const& element_tag_config,
+               Fields& element_out) -> std::expected<void, dynser::SerializeError> {
+            auto& element_state = *handle;
+            element_state[keywords::INPUT_TABLE] = element_props;
+            element_state[keywords::OUTPUT_TABLE] = Fields{};
+            // run precompiled script
+            if (const auto& script = element_tag_config.serialization_bytecode) {
+                const auto script_run_result = handle.run(*script);
                 if (script_run_result != LUA_OK) {
-                    const auto error = state.read<std::string>(-1);
-                    return std::unexpected{ SerializeError{ serialize_err::ScriptError{ error }, props } };
+                    const auto error = element_state.read<std::string>(-1);
+                    return std::unexpected{
+                        SerializeError{ serialize_err::ScriptError{ error }, element_props.to_properties() }
+                    };
                 }
             }
-            return state[keywords::OUTPUT_TABLE].read<dynser::Fields>();
+            lua_getglobal(element_state, keywords::OUTPUT_TABLE);
+            luwra::Value<Fields>::read_into(element_state, -1, element_out);
+            lua_pop(element_state, 1);
+            return {};
         };
 
         Fields fields;
         if (!non_list_props.empty()) {
-            auto non_list_fields_sus = props_to_fields(state, non_list_props, tag_config);
-            if (!non_list_fields_sus) {
+            if (auto non_list_fields_sus = props_to_fields(state_handle, non_list_props, tag_config, fields);
+                !non_list_fields_sus)
+            {
                 return make_serialize_err(std::move(non_list_fields_sus.error().error), props);
             }
-            fields = *non_list_fields_sus;
         }    // else only list-fields
 
-        // input (unflattened_props_vector): [ { 'b': 1 }, { 'b': 2 }, { 'b': 3 } ]
-        // output (unflattened_fields): [ { 'b': '1' }, { 'b': '2' }, { 'b': '3' } ]
-        std::vector<Fields> unflattened_fields;    // for recurrent
-        // FIXME realization looks bad, especially this check
-        if (std::holds_alternative<Recurrent>(tag_config.nested) && !unflattened_props_vector.empty()) {
-            for (auto const& unflattened_props : unflattened_props_vector) {
-                auto unflattened_fields_sus = props_to_fields(state, unflattened_props, tag_config);
-                if (!unflattened_fields_sus) {
-                    return make_serialize_err(std::move(unflattened_fields_sus.error().error), props);
-                }
-                unflattened_fields.push_back(*unflattened_fields_sus);
-            }
-        }
-
         // nested
         return util::visit_one_terminated(
             tag_config.nested,
-            [&](const Continual& continual) -> SerializeResult {
+            [&](const Continual& continual) -> SerializeToResult {
                 using namespace config::details;
-                std::string result;
 
                 for (std::size_t rule_ind{}; rule_ind < continual.size(); ++rule_ind) {
                     const auto& rule = continual[rule_ind];
 
                     auto serialized_continual = util::visit_one_terminated(
                         rule,
-                        gen_existing_process_helper<ConExisting>(props, fields),
-                        gen_linear_process_helper<ConLinear>(props, fields)
+                        gen_existing_process_helper<ConExisting>(out, props, fields, chunked),
+                        gen_linear_process_helper<ConLinear>(out, props, fields)
                     );
                     if (!serialized_continual) {
                         // add ref to outside rule
                         append_ref_to_err(serialized_continual.error(), { std::string{ tag }, rule_ind });
                         return serialized_continual;
                     }
-                    result += *serialized_continual;
+                    try_flush(out, chunked);
                 }
 
-                return result;
+                return {};
             },
-            [&](const Branched& branched) -> SerializeResult {
-                luwra::StateWrapper branched_script_state;
-                branched_script_state.loadStandardLibrary();
-                register_userdata_property_value(branched_script_state);
-
-                branched_script_state[keywords::CONTEXT] = context;
-                branched_script_state[keywords::INPUT_TABLE] = props;
+            [&](const Branched& branched) -> SerializeToResult {
+                // run in serialization script state: 'ctx' and 'out' are already set,
+                // 'inp' is reset only if serialization script received another props
+                if (non_list_props.empty() || non_list_props.size() != props.size()) {
+                    state[keywords::INPUT_TABLE] = props;
+                }
                 using keywords::BRANCHED_RULE_IND_ERRVAL;
-                branched_script_state[keywords::BRANCHED_RULE_IND_VARIABLE] = BRANCHED_RULE_IND_ERRVAL;
-                const auto branched_script_run_result =
-                    branched_script_state.runString(branched.branching_script.c_str());
+                state[keywords::BRANCHED_RULE_IND_VARIABLE] = BRANCHED_RULE_IND_ERRVAL;
+                const auto branched_script_run_result = state_handle.run(branched.branching_bytecode);
                 if (branched_script_run_result != LUA_OK) {
-                    const auto error = branched_script_state.read<std::string>(-1);
+                    const auto error = state.read<std::string>(-1);
                     return make_serialize_err(serialize_err::ScriptError{ error }, props);
                 }
-                const auto branched_rule_ind = branched_script_state[keywords::BRANCHED_RULE_IND_VARIABLE].read<int>();
+                const auto branched_rule_ind = state[keywords::BRANCHED_RULE_IND_VARIABLE].read<int>();
                 if (branched_rule_ind == BRANCHED_RULE_IND_ERRVAL) {
                     return make_serialize_err(serialize_err::BranchNotSet{}, props);
                 }
-                if (branched_rule_ind >= branched.rules.size()) {
+                if (static_cast<std::size_t>(branched_rule_ind) >= branched.rules.size()) {
                     return make_serialize_err(
                         serialize_err::BranchOutOfBounds{ .selected_branch =
                                                               static_cast<std::uint32_t>(branched_rule_ind),
@@ -627,8 +1323,8 @@ public:
 
                 auto serialized_branched = util::visit_one_terminated(
                     branched.rules[branched_rule_ind],
-                    gen_existing_process_helper<BraExisting>(props, fields),
-                    gen_linear_process_helper<BraLinear>(props, fields)
+                    gen_existing_process_helper<BraExisting>(out, props, fields, chunked),
+                    gen_linear_process_helper<BraLinear>(out, props, fields)
                 );
 
                 if (!serialized_branched) {
@@ -639,9 +1335,7 @@ public:
                 }
                 return serialized_branched;
             },
-            [&](const Recurrent& recurrent) -> SerializeResult {
-                std::string result;
-
+            [&](const Recurrent& recurrent) -> SerializeToResult {
                 // max length of property lists
                 // FIXME is priority unused?
                 if (const auto calc_lists_len_result =
@@ -649,97 +1343,664 @@ public:
                 {
                     const auto max_len = calc_lists_len_result->second;
 
+                    // list properties are found once, element buffers are reused between elements
+                    const auto list_props = props.lists();
+                    PropertiesView element_props;
+                    Fields element_fields;
                     for (std::size_t ind{}; ind < max_len; ++ind) {
-                        for (const auto& recurrent_rule : recurrent) {
-                            // split lists in props and fields into current element
-                            auto curr_fields = fields;
-                            if (unflattened_fields.size() > ind) {
-                                curr_fields.merge(unflattened_fields[ind]);
-                            }
-                            auto curr_props = props;
-                            if (unflattened_props_vector.size() > ind) {
-                                for (auto const& [key, val] : unflattened_props_vector[ind]) {
-                                    curr_props[key] = val;
-                                }
+                        // input (element_props): { 'b': 1 } for ind = 0
+                        // output (element_fields): { 'b': '1' }
+                        list_props.list_elements(ind, element_props);
+                        element_fields.clear();
+                        if (!element_props.empty()) {
+                            if (auto element_fields_sus =
+                                    props_to_fields(state_handle, element_props, tag_config, element_fields);
+                                !element_fields_sus)
+                            {
+                                return make_serialize_err(std::move(element_fields_sus.error().error), props);
                             }
+                        }
+
+                        // current element of lists on top of props and fields (nothing is copied):
+                        // element props replace list props, non-list fields take precedence over element ones
+                        const OverlaidPropertiesView curr_props{ props, element_props };
+                        const util::LayeredMap<Fields> curr_fields{ fields, element_fields };
+                        for (const auto& recurrent_rule : recurrent) {
                             const auto serialized_recurrent = util::visit_one_terminated(
                                 recurrent_rule,
-                                gen_existing_process_helper<RecExisting>(curr_props, curr_fields),
-                                gen_linear_process_helper<RecLinear>(curr_props, curr_fields),
-                                [&](const RecInfix& rule) -> SerializeResult {
+                                gen_existing_process_helper<RecExisting>(out, curr_props, curr_fields, chunked),
+                                gen_linear_process_helper<RecLinear>(out, curr_props, curr_fields),
+                                [&](const RecInfix& rule) -> SerializeToResult {
                                     if (ind == max_len - 1) {
-                                        return "";    // infix rule -> return empty string on last element
+                                        return {};    // infix rule -> empty string on last element
                                     }
 
-                                    return gen_linear_process_helper<RecInfix>(curr_props, curr_fields)(rule);
+                                    return gen_linear_process_helper<RecInfix>(out, curr_props, curr_fields)(rule);
                                 }
                             );
                             if (!serialized_recurrent) {
                                 return serialized_recurrent;
                             }
-                            result += *serialized_recurrent;
+                            try_flush(out, chunked);
                         }
                     }
                 }
 
-                return result;
+                return {};
             },
-            [&](const RecurrentDict& recurrent_dict) -> SerializeResult {
-                std::string result;
-
+            [&](const RecurrentDict& recurrent_dict) -> SerializeToResult {
                 if (!props.contains(recurrent_dict.key)) {
                     return make_serialize_err(serialize_err::RecurrentDictKeyNotFound{ recurrent_dict.key }, props);
                 }
-                for (std::size_t ind{}; auto const& dict : props.at(recurrent_dict.key).as_const_list()) {
-                    auto serialize_result = serialize_props(dict.as_const_map(), recurrent_dict.tag);
+                auto const& dicts = props.at(recurrent_dict.key).as_const_list();
+                if (thread_pool_ && dicts.size() >= min_parallel_len_) {
+                    return serialize_recurrent_dict_parallel(out, dicts, recurrent_dict.tag, tag, chunked);
+                }
+                for (std::size_t ind{}; auto const& dict : dicts) {
+                    auto serialize_result =
+                        serialize_props_to(out, PropertiesView{ dict.as_const_map() }, recurrent_dict.tag, chunked);
 
                     if (!serialize_result) {
                         append_ref_to_err(serialize_result.error(), { std::string{ tag }, ind });
 
                         return serialize_result;
                     }
-
-                    result += *serialize_result;
+                    try_flush(out, chunked);
 
                     ++ind;
                 }
-                return result;
+                return {};
             }
         );
     }
 
+    /**
+     * \brief Run deserialization and debranching scripts of tag in acquired state (with 'ctx' set).
+     * Fields are passed to 'inp' as strings, 'out' is read as properties.
+     * Without deserialization script fields are passed to output as is (and lua is not used at all if
+     * there is no debranching script to run), as views in CaptureMode::View.
+     */
+    static deserialize::ScriptResult run_deserialization_scripts(
+        lua::StatePool::Handle& state_handle,
+        const deserialize::ScriptCall& call,
+        const deserialize::CaptureMode mode
+    ) noexcept
+    {
+        using namespace config;
+
+        auto const& script = call.tag.deserialization_bytecode;
+        auto const* const branched = std::get_if<yaml::Branched>(&call.tag.nested);
+        if (!script && !(branched && call.branch)) {
+            Properties result;
+            for (auto const& [name, value] : call.fields) {
+                auto property = mode == deserialize::CaptureMode::View ? PropertyValue{ value }
+                                                                       : PropertyValue{ std::string{ value } };
+                result.insert_or_assign(std::string{ name }, std::move(property));
+            }
+            return result;
+        }
+
+        lua_State* const state = *state_handle;
+        // strings are copied into lua only
+        const auto push_fields = [&] {
+            lua_createtable(state, 0, static_cast<int>(call.fields.size()));
+            for (auto const& [name, value] : call.fields) {
+                lua_pushlstring(state, name.data(), name.size());
+                lua_pushlstring(state, value.data(), value.size());
+                lua_rawset(state, -3);
+            }
+        };
+        const auto run = [&](const lua::CompileResult& bytecode) -> std::optional<std::string> {
+            if (!bytecode) {
+                return bytecode.error();
+            }
+            if (state_handle.run(*bytecode) == LUA_OK) {
+                return std::nullopt;
+            }
+            auto error = state_handle->read<std::string>(-1);
+            lua_pop(state, 1);
+            return error;
+        };
+
+        push_fields();
+        lua_setglobal(state, keywords::INPUT_TABLE);
+        if (script) {
+            lua_newtable(state);
+        }
+        else {
+            push_fields();
+        }
+        lua_setglobal(state, keywords::OUTPUT_TABLE);
+
+        if (script) {
+            if (auto error = run(*script)) {
+                return std::unexpected{ std::move(*error) };
+            }
+        }
+        if (branched && call.branch) {
+            lua_pushinteger(state, static_cast<lua_Integer>(*call.branch));
+            lua_setglobal(state, keywords::BRANCHED_RULE_IND_VARIABLE);
+            if (auto error = run(branched->debranching_bytecode)) {
+                return std::unexpected{ std::move(*error) };
+            }
+        }
+
+        lua_getglobal(state, keywords::OUTPUT_TABLE);
+        auto result = read_properties(state, -1);
+        lua_pop(state, 1);
+        return result;
+    }
+
+    /**
+     * \brief Matcher of linear rule with dyn-groups (values are taken from context), nullptr if pattern is invalid.
+     */
+    regex::Matcher const* resolve_dyn_matcher(const deserialize::Program::Linear& linear) noexcept
+    {
+        const auto dyn_group_values =
+            dynser::details::merge_maps(*linear.dyn_groups, dynser::details::props_to_fields(*context_));
+        if (!dyn_group_values) {
+            return nullptr;
+        }
+        details::DynPatternKey key{
+            .pattern = config::details::resolve_dyn_regex(*linear.dyn_pattern, *dyn_group_values),
+            .with_whole_match_group = linear.with_whole_match_group,
+        };
+        auto const* matcher = dyn_matchers_.find(key);
+        if (!matcher) {
+            auto compiled = config::details::compile_regex(key.pattern, key.with_whole_match_group);
+            matcher = &dyn_matchers_.insert(
+                key, compiled ? std::optional{ *compiled->matcher } : std::nullopt
+            );
+        }
+        return *matcher ? &**matcher : nullptr;
+    }
+
+    /**
+     * \brief Check config and tag, compile deserialization program on first use.
+     */
     template <typename Target>
-        requires requires(Target target) {
+    DeserializeResult<Target> prepare_deserialization(const std::string_view sv, const std::string_view tag) noexcept
+    {
+        if (!config_) {
+            return make_deserialize_err<Target>(deserialize_err::ConfigNotLoaded{}, sv);
+        }
+        if (!config_->tags.contains(std::string{ tag })) {
+            return make_deserialize_err<Target>(deserialize_err::ConfigTagNotFound{ std::string{ tag } }, sv);
+        }
+        if (!deserialize_program_) {
+            deserialize_program_ = std::make_shared<const deserialize::Program>(*config_, deserialize_memo_);
+        }
+        return {};
+    }
+
+    /**
+     * \brief Call run with program callbacks, scripts are run in one acquired state (with 'ctx' set).
+     */
+    template <typename Run>
+    decltype(auto) with_deserialization_callbacks(const deserialize::CaptureMode mode, const Run& run) noexcept
+    {
+        auto state_handle = lua_states_.acquire();
+        (*state_handle)[config::keywords::CONTEXT] = *context_;
+
+        return run(
+            [this](const deserialize::Program::Linear& linear) { return resolve_dyn_matcher(linear); },
+            [&state_handle, mode](const deserialize::ScriptCall& call) {
+                return run_deserialization_scripts(state_handle, call, mode);
+            }
+        );
+    }
+
+    /**
+     * \param sv part of input at sv_position, scope is taken from it.
+     */
+    template <typename Target>
+    static DeserializeResult<Target> make_match_err(
+        deserialize::MatchError&& error,
+        const std::string_view sv,
+        const std::size_t sv_position = 0
+    ) noexcept
+    {
+        const auto scope =
+            sv.substr(std::min(error.position - sv_position, sv.size()), details::deserialize_err_scope_len);
+        if (error.script_error) {
+            return make_deserialize_err<Target>(deserialize_err::ScriptError{ std::move(*error.script_error) }, scope);
+        }
+        return make_deserialize_err<Target>(deserialize_err::NoMatch{ error.position }, scope);
+    }
+
+    /**
+     * \brief Deserialize recurrent tag by elements split by separator scan (see split_elements) on thread pool.
+     * Used only if element can't contain separator outside of brackets (see Program::is_separable), so parts are
+     * exactly elements. Elements after failed one are skipped, error of first failed element is returned.
+     * \return std::nullopt if input can't be split (deserialized sequentially then).
+     */
+    std::optional<DeserializeResult<Properties>> deserialize_recurrent_parallel(
+        const std::string_view sv,
+        const std::string_view tag,
+        const deserialize::CaptureMode mode
+    ) noexcept
+    {
+        using Target = Properties;
+        using List = PropertyValue::ListType<PropertyValue>;
+
+        const auto separator = deserialize_program_->separator(tag);
+        if (!separator || !deserialize_program_->is_separable(tag)) {
+            return std::nullopt;
+        }
+        const auto parts = deserialize::split_elements(sv, *separator);
+        if (!parts || parts->size() < 2) {
+            return std::nullopt;
+        }
+
+        struct ChunkError
+        {
+            std::size_t ind;
+            std::size_t offset;    // of element in sv
+            deserialize::MatchError error;
+        };
+
+        std::vector<Properties> elements(parts->size());
+        std::atomic<std::size_t> first_failed{ parts->size() };
+        std::atomic<bool> is_mismatched{};
+        std::mutex errors_mutex;
+        std::vector<ChunkError> errors;
+        thread_pool_->for_each_chunk(
+            parts->size(),
+            details::min_parallel_chunk_len,
+            [&](const std::size_t begin, const std::size_t end) noexcept {
+                auto chunk_session = session();
+                chunk_session.with_deserialization_callbacks(mode, [&](const auto& resolve, const auto& run_scripts) {
+                    auto const& program = *chunk_session.deserialize_program_;
+                    for (auto ind = begin; ind < end && ind < first_failed.load() && !is_mismatched.load(); ++ind) {
+                        const auto part = (*parts)[ind];
+                        const auto offset = static_cast<std::size_t>(part.data() - sv.data());
+                        const auto is_last = ind + 1 == parts->size();
+                        // not last element is matched with separator, rest of input is passed for lookups
+                        auto element =
+                            program.run_element(is_last ? part : sv.substr(offset), tag, is_last, resolve, run_scripts);
+                        if (!element) {
+                            std::lock_guard lock{ errors_mutex };
+                            errors.push_back({ ind, offset, std::move(element.error()) });
+                            auto failed = first_failed.load();
+                            while (ind < failed && !first_failed.compare_exchange_weak(failed, ind)) { }
+                            return;
+                        }
+                        if (element->length != (is_last ? part.size() : part.size() + separator->size())) {
+                            is_mismatched = true;
+                            return;
+                        }
+                        elements[ind] = std::move(element->props);
+                    }
+                });
+            }
+        );
+        if (is_mismatched) {
+            return std::nullopt;
+        }
+        if (!errors.empty()) {
+            auto& error = *std::ranges::min_element(errors, {}, &ChunkError::ind);
+            error.error.position += error.offset;
+            return make_match_err<Target>(std::move(error.error), sv);
+        }
+
+        // merged as in sequential deserialization
+        Properties result;
+        for (auto& element : elements) {
+            for (auto& [key, value] : element) {
+                auto& list = result.try_emplace(key, List{}).first->second;
+                if (list.is_list()) {
+                    list.as_list().push_back(std::move(value));
+                }
+            }
+        }
+        return result;
+    }
+
+public:
+    /**
+     * \brief Match whole sv as tag and convert captured fields by deserialization scripts.
+     * Existing rules properties are merged into parent ones (with prefix if set), recurrent elements
+     * properties are merged as lists, recurrent-dict elements are list of maps.
+     * Rules and branches are tried in order, failed rule (or script error) backtracks to previous alternative.
+     * \param mode CaptureMode::View: fields without deserialization script are not copied, sv must outlive result
+     * (or materialize it). Viewed strings are read by as_const_string_view (or as_string, what materializes them),
+     * they are passed to scripts as owned strings if result is serialized back.
+     * \note if thread pool is set (see set_thread_pool), long input of recurrent tag with literal separator
+     * is split by separators outside of brackets and elements are deserialized in parallel, if element can't
+     * contain separator outside of brackets (see Program::is_separable).
+     */
+    DeserializeResult<Properties> deserialize_to_props(
+        const std::string_view sv,
+        const std::string_view tag,
+        const deserialize::CaptureMode mode = deserialize::CaptureMode::Copy
+    ) noexcept
+    {
+        using Target = Properties;
+
+        if (auto prepared = prepare_deserialization<void>(sv, tag); !prepared) {
+            return std::unexpected{ std::move(prepared.error()) };
+        }
+        if (thread_pool_ && sv.size() >= details::min_parallel_deserialize_len) {
+            if (auto result = deserialize_recurrent_parallel(sv, tag, mode)) {
+                return std::move(*result);
+            }
+        }
+        auto result = with_deserialization_callbacks(mode, [&](const auto& resolve, const auto& run_scripts) {
+            return deserialize_program_->run(sv, tag, resolve, run_scripts);
+        });
+        if (!result) {
+            return make_match_err<Target>(std::move(result.error()), sv);
+        }
+        return std::move(*result);
+    }
+
+    /**
+     * \brief Push-style deserialization started by deserialize_stream.
+     * \note DynSer (or session) must outlive stream, config reloads don't affect it.
+     */
+    class DeserializeStream
+    {
+        friend class Session;
+
+        Session* ser_;
+        // program points into config
+        std::shared_ptr<const config::CompiledConfig> config_;
+        std::shared_ptr<const deserialize::Program> program_;
+        deserialize::Stream stream_;
+
+        explicit DeserializeStream(
+            Session& ser,
+            const std::string_view tag,
+            deserialize::Stream::OnElement&& on_element
+        ) noexcept
+          : ser_{ &ser }
+          , config_{ ser.config_ }
+          , program_{ ser.deserialize_program_ }
+          , stream_{ *program_, tag, std::move(on_element) }
+        { }
+
+    public:
+        /**
+         * \brief Append chunk, completed elements are passed to callback.
+         * \return error as soon as input can't be completed by next chunks (finish returns it too).
+         */
+        DeserializeResult<void> feed(const std::string_view chunk) noexcept
+        {
+            auto result = ser_->with_deserialization_callbacks(
+                deserialize::CaptureMode::Copy,
+                [&](const auto& resolve, const auto& run_scripts) { return stream_.feed(chunk, resolve, run_scripts); }
+            );
+            if (!result) {
+                return make_match_err<void>(std::move(result.error()), stream_.buffered(), stream_.consumed());
+            }
+            return {};
+        }
+
+        /**
+         * \brief Match rest of input, error position is counted from begin of whole input.
+         */
+        DeserializeResult<void> finish() noexcept
+        {
+            auto result = ser_->with_deserialization_callbacks(
+                deserialize::CaptureMode::Copy,
+                [&](const auto& resolve, const auto& run_scripts) { return stream_.finish(resolve, run_scripts); }
+            );
+            if (!result) {
+                return make_match_err<void>(std::move(result.error()), stream_.buffered(), stream_.consumed());
+            }
+            return {};
+        }
+
+        /**
+         * \brief Fed input what is not matched yet.
+         */
+        [[nodiscard]] std::string_view buffered() const noexcept { return stream_.buffered(); }
+    };
+
+    /**
+     * \brief Deserialize recurrent tag from input fed by chunks (e.g. read from pipe), each element properties
+     * are passed to on_element as soon as element and infix after it are matched (and can't be changed by next
+     * chunks). Invalid input is reported as soon as it can't be completed, so memory is bounded by longest
+     * element (and chunk), not by whole input.
+     * Tag without infix is matched on finish only, not recurrent tag is passed to on_element as one element.
+     */
+    DeserializeResult<DeserializeStream>
+    deserialize_stream(const std::string_view tag, deserialize::Stream::OnElement on_element) noexcept
+    {
+        if (auto prepared = prepare_deserialization<void>({}, tag); !prepared) {
+            return std::unexpected{ std::move(prepared.error()) };
+        }
+        return DeserializeStream{ *this, tag, std::move(on_element) };
+    }
+};
+
+/**
+ * \brief string <=> target convertion based on Mappers and config file.
+ * \tparam PropertyToTargetMapper functor what receives properties struct (and context) and returns target.
+ * \tparam TargetToPropertyMapper functor what receives target (and context) and returns properties struct.
+ */
+template <typename PropertyToTargetMapper, typename TargetToPropertyMapper>
+class DynSer : public Session
+{
+    config::ParseResult from_file(const config::RawContents& wrapper) noexcept
+    {
+        return config::from_string(wrapper.config);
+    }
+
+    config::ParseResult from_file(const config::FileName& wrapper) noexcept
+    {
+        std::ifstream file{ wrapper.config_file_name };
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return from_file(config::RawContents(buffer.str()));
+    }
+
+public:
+    const PropertyToTargetMapper pttm;
+    const TargetToPropertyMapper ttpm;
+    Context context;
+
+    DynSer() noexcept
+      : pttm{ generate_property_to_target_mapper() }
+      , ttpm{ generate_target_to_property_mapper() }
+    {
+        bind_context(context);
+    }
+
+    DynSer(PropertyToTargetMapper&& pttm, TargetToPropertyMapper&& ttpm) noexcept
+      : pttm{ std::move(pttm) }
+      , ttpm{ std::move(ttpm) }
+    {
+        bind_context(context);
+    }
+
+    // copy reads its own context
+    DynSer(const DynSer& other) noexcept
+      : Session{ other }
+      , pttm{ other.pttm }
+      , ttpm{ other.ttpm }
+      , context{ other.context }
+    {
+        bind_context(context);
+    }
+
+    DynSer(DynSer&& other) noexcept
+      : Session{ std::move(other) }
+      , pttm{ std::move(other.pttm) }
+      , ttpm{ std::move(other.ttpm) }
+      , context{ std::move(other.context) }
+    {
+        bind_context(context);
+    }
+
+    template <typename ConfigWrapper>
+    config::ParseResult load_config(ConfigWrapper&& wrapper) noexcept
+    {
+        auto config = from_file(std::forward<ConfigWrapper>(wrapper));
+        if (config) {
+            config_ = std::make_shared<const config::CompiledConfig>(std::move(*config));
+            deserialize_program_.reset();
+        }
+        return config;
+    }
+
+    template <typename ConfigWrapper>
+    config::ParseResult merge_config(ConfigWrapper&& wrapper) noexcept
+    {
+        auto config = from_file(std::forward<ConfigWrapper>(wrapper));
+        if (config) {
+            // copy on write, other sessions keep using old config
+            auto merged = config_ ? std::make_shared<config::CompiledConfig>(*config_)
+                                  : std::make_shared<config::CompiledConfig>();
+            merged->merge(std::move(*config));
+            config_ = std::move(merged);
+            deserialize_program_.reset();
+        }
+        return config;
+    }
+
+    /**
+     * \brief Use config loaded by another instance, config is not copied.
+     */
+    void use_config(std::shared_ptr<const config::CompiledConfig> config) noexcept
+    {
+        config_ = std::move(config);
+        deserialize_program_.reset();
+    }
+
+    /**
+     * \brief Serialize recurrent-dicts with at least min_len elements in parallel, nullptr disables it.
+     * Output and errors are the same as in sequential serialization.
+     * Long input of recurrent tag with literal separator is deserialized in parallel too (see deserialize_to_props).
+     */
+    void set_thread_pool(
+        std::shared_ptr<parallel::ThreadPool> pool,
+        const std::size_t min_len = details::min_parallel_recurrent_dict_len
+    ) noexcept
+    {
+        thread_pool_ = std::move(pool);
+        min_parallel_len_ = min_len;
+    }
+
+    /**
+     * \brief Memoization of tag calls results in deserialization (limits memory of one deserialization).
+     */
+    void set_deserialize_memo(const deserialize::MemoOptions options) noexcept
+    {
+        deserialize_memo_ = options;
+        deserialize_program_.reset();
+    }
+
+    using Session::serialize_batch;
+    using Session::serialize_batch_parallel;
+
+    /**
+     * \brief Serialize target directly into sink (std::string, std::ostream or callback receiving std::string_view).
+     * String is appended to (and left unchanged on error), stream or callback receives fragments as soon as
+     * they are serialized (see serialize_props_to).
+     */
+    template <typename Sink, typename Target>
+        requires(std::same_as<Sink, std::string> || SerializeSink<Sink>) && requires(Target target) {
             {
                 ttpm(context, target)
             } -> std::same_as<dynser::Properties>;
         }
-    SerializeResult serialize(const Target& target, const std::string_view tag) noexcept
+    SerializeToResult serialize_to(Sink& sink, const Target& target, const std::string_view tag) noexcept
     {
         if (!config_) {
-            return make_serialize_err(serialize_err::ConfigNotLoaded{}, {});
+            return make_serialize_err(serialize_err::ConfigNotLoaded{}, Properties{});
         }
 
-        return serialize_props(ttpm(context, target), tag);
+        return serialize_props_to(sink, ttpm(context, target), tag);
     }
 
-    DeserializeResult<Properties> deserialize_to_props(const std::string_view sv, const std::string_view tag) noexcept
+    template <typename Target>
+        requires requires(Target target) {
+            {
+                ttpm(context, target)
+            } -> std::same_as<dynser::Properties>;
+        }
+    SerializeResult serialize(const Target& target, const std::string_view tag) noexcept
     {
-        using Target = Properties;
+        std::string result;
+        if (auto serialize_result = serialize_to(result, target, tag); !serialize_result) {
+            return std::unexpected{ std::move(serialize_result.error()) };
+        }
+        return result;
+    }
 
-        if (!config_) {
-            return make_deserialize_err<Target>(deserialize_err::ConfigNotLoaded{}, sv);
+    /**
+     * \brief Same as serialize_batch of properties, targets are mapped one by one.
+     */
+    template <typename Target>
+        requires requires(Target target) {
+            {
+                ttpm(context, target)
+            } -> std::same_as<dynser::Properties>;
         }
-        if (!config_->tags.contains(std::string{ tag })) {
-            return make_deserialize_err<Target>(deserialize_err::ConfigTagNotFound{ std::string{ tag } }, sv);
+    SerializeToResult
+    serialize_batch(const std::span<const Target> batch, const std::string_view tag, SerializedBatch& out) noexcept
+    {
+        return serialize_batch_impl(batch, [this](const Target& target) { return ttpm(context, target); }, tag, out);
+    }
+
+    template <typename Target>
+        requires requires(Target target) {
+            {
+                ttpm(context, target)
+            } -> std::same_as<dynser::Properties>;
+        }
+    SerializeBatchResult serialize_batch(const std::span<const Target> batch, const std::string_view tag) noexcept
+    {
+        SerializedBatch result;
+        if (auto serialize_result = serialize_batch<Target>(batch, tag, result); !serialize_result) {
+            return std::unexpected{ std::move(serialize_result.error()) };
         }
+        return result;
+    }
 
-        dynser::Properties result;
+    /**
+     * \brief Same as serialize_props_chunked, target is mapped to properties first.
+     */
+    template <SerializeSink Sink, typename Target>
+        requires requires(Target target) {
+            {
+                ttpm(context, target)
+            } -> std::same_as<dynser::Properties>;
+        }
+    SerializeToResult serialize_chunked(
+        const Target& target,
+        const std::string_view tag,
+        const std::size_t chunk_size,
+        Sink& sink
+    ) noexcept
+    {
+        if (!config_) {
+            return make_serialize_err(serialize_err::ConfigNotLoaded{}, Properties{});
+        }
 
-        // process rules to match fields in sv
-        // process scripts to convert fields to props
+        return serialize_props_chunked(ttpm(context, target), tag, chunk_size, sink);
+    }
 
-        return result;
+    /**
+     * \brief Same as serialize_batch_parallel of properties, targets are mapped by sessions.
+     * \note mappers receive context copy of their chunk, changes made by them are discarded.
+     */
+    template <typename Target>
+        requires requires(Target target) {
+            {
+                ttpm(context, target)
+            } -> std::same_as<dynser::Properties>;
+        }
+    std::vector<SerializeResult>
+    serialize_batch_parallel(const std::span<const Target> batch, const std::string_view tag) noexcept
+    {
+        return serialize_batch_parallel_impl(
+            batch.size(),
+            [&](Session& session, Context& chunk_context, const std::size_t ind) noexcept {
+                return session.serialize_props(ttpm(chunk_context, batch[ind]), tag);
+            }
+        );
     }
 
     template <typename Target>
@@ -748,14 +2009,26 @@ public:
                 pttm(context, props, target)
             } -> std::same_as<void>;
         }
-    DeserializeResult<Target> deserialize(const std::string_view sv, const std::string_view tag) noexcept
+    /**
+     * \param mode CaptureMode::View: fields are not copied while input is matched (and backtracked),
+     * accepted ones are materialized once before mapper gets them.
+     */
+    DeserializeResult<Target> deserialize(
+        const std::string_view sv,
+        const std::string_view tag,
+        const deserialize::CaptureMode mode = deserialize::CaptureMode::Copy
+    ) noexcept
     {
-        auto props_sus = deserialize_to_props(sv, tag);
+        auto props_sus = deserialize_to_props(sv, tag, mode);
 
         if (!props_sus) {
             return std::unexpected{ props_sus.error() };
         }
 
+        // mappers read strings by string accessors
+        if (mode == deserialize::CaptureMode::View) {
+            materialize(*props_sus);
+        }
         Target result;
         pttm(context, *props_sus, result);
         return result;
@@ -0,0 +1,40 @@
+#include "script.h"
+
+#include "luwra.hpp"
+
+#include <atomic>
+#include <memory>
+
+namespace
+{
+
+std::atomic<std::uint64_t> last_script_id{};
+
+int bytecode_writer(lua_State*, const void* data, std::size_t size, void* out) noexcept
+{
+    static_cast<std::string*>(out)->append(static_cast<const char*>(data), size);
+    return 0;
+}
+
+}    // namespace
+
+dynser::lua::CompileResult
+dynser::lua::compile(const std::string_view source, const std::string_view chunk_name) noexcept
+{
+    const std::unique_ptr<lua_State, decltype(&lua_close)> state{ luaL_newstate(), &lua_close };
+    if (!state) {
+        return std::unexpected{ "not enough memory" };
+    }
+
+    // '=' prefix to use name as is in error messages
+    const auto name = "=" + std::string{ chunk_name };
+    if (luaL_loadbufferx(state.get(), source.data(), source.size(), name.c_str(), "t") != LUA_OK) {
+        return std::unexpected{ std::string{ lua_tostring(state.get(), -1) } };
+    }
+
+    CompiledScript result{ .bytecode = {}, .id = ++last_script_id };
+    // not stripped to keep line numbers in runtime errors
+    lua_dump(state.get(), &bytecode_writer, &result.bytecode, 0);
+
+    return result;
+}
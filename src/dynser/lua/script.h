@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+
+namespace dynser::lua
+{
+
+/**
+ * \brief Lua chunk compiled to bytecode (on config load).
+ */
+struct CompiledScript
+{
+    std::string bytecode;
+
+    // unique for every compilation, key of loaded functions cache in lua states
+    std::uint64_t id;
+};
+
+// error message if error
+using CompileResult = std::expected<CompiledScript, std::string>;
+
+/**
+ * \brief Parse script and dump it to bytecode.
+ * \param chunk_name used in error messages (e.g. 'name:1: unexpected symbol near...').
+ */
+CompileResult compile(const std::string_view source, const std::string_view chunk_name) noexcept;
+
+}    // namespace dynser::lua
@@ -0,0 +1,129 @@
+#include "state_pool.h"
+
+#include "structs/properties.h"
+
+namespace
+{
+
+// least recently run functions are dropped (e.g. of reloaded configs), scripts of one config usually fit
+constexpr std::size_t max_loaded_scripts = 1024;
+
+/**
+ * \brief Remove all fields of table on the stack top (fields of its __index are kept).
+ */
+void clear_table(lua_State* state) noexcept
+{
+    lua_pushnil(state);
+    while (lua_next(state, -2) != 0) {
+        // existing fields may be cleared during traversal
+        lua_pop(state, 1);
+        lua_pushvalue(state, -1);
+        lua_pushnil(state);
+        lua_rawset(state, -4);
+    }
+}
+
+/**
+ * \brief Move standard library (and everything else registered before scripts run) from globals to __index of
+ * globals, so globals table holds only variables set by scripts and dynser, and is cleared on release.
+ */
+void move_globals_to_index(lua_State* state) noexcept
+{
+    lua_pushglobaltable(state);
+    lua_newtable(state);
+    lua_pushnil(state);
+    while (lua_next(state, -3) != 0) {
+        lua_pushvalue(state, -2);
+        lua_insert(state, -2);
+        lua_rawset(state, -4);
+    }
+    lua_insert(state, -2);
+    clear_table(state);
+
+    lua_newtable(state);    // metatable of globals
+    lua_rotate(state, -3, -1);
+    lua_setfield(state, -2, "__index");
+    lua_setmetatable(state, -2);
+    lua_pop(state, 1);
+}
+
+}    // namespace
+
+dynser::lua::StatePool::Handle::Handle(StatePool& pool, PooledState&& pooled) noexcept
+  : pool_{ &pool }
+  , pooled_{ std::move(pooled) }
+{ }
+
+dynser::lua::StatePool::Handle::Handle(Handle&& other) noexcept
+  : pool_{ other.pool_ }
+  , pooled_{ std::move(other.pooled_) }
+{ }
+
+dynser::lua::StatePool::Handle::~Handle() noexcept
+{
+    if (pooled_.state) {
+        pool_->release(std::move(pooled_));
+    }
+}
+
+int dynser::lua::StatePool::Handle::run(CompiledScript const& script) noexcept
+{
+    lua_State* const raw_state = *pooled_.state;
+    auto& loaded = pooled_.loaded_scripts;
+
+    auto const* ref = loaded.find(script.id);
+    if (!ref) {
+        const auto load_result = luaL_loadbufferx(
+            raw_state, script.bytecode.data(), script.bytecode.size(), nullptr /* name stored in bytecode */, "b"
+        );
+        if (load_result != LUA_OK) {
+            return load_result;
+        }
+        ref = &loaded.insert(script.id, luaL_ref(raw_state, LUA_REGISTRYINDEX), [&](auto, const int dropped) {
+            luaL_unref(raw_state, LUA_REGISTRYINDEX, dropped);
+        });
+    }
+
+    lua_rawgeti(raw_state, LUA_REGISTRYINDEX, *ref);
+    return lua_pcall(raw_state, 0, 0, 0);
+}
+
+dynser::lua::StatePool::StatePool(StatePool const&) noexcept
+  : idle_{}
+{ }
+
+dynser::lua::StatePool& dynser::lua::StatePool::operator=(StatePool const&) noexcept
+{
+    // keep own states
+    return *this;
+}
+
+dynser::lua::StatePool::Handle dynser::lua::StatePool::acquire() noexcept
+{
+    if (!idle_.empty()) {
+        auto pooled = std::move(idle_.back());
+        idle_.pop_back();
+        return Handle{ *this, std::move(pooled) };
+    }
+
+    auto state = std::make_unique<luwra::StateWrapper>();
+    state->loadStandardLibrary();
+    register_userdata_property_value(*state);
+    move_globals_to_index(*state);
+    return Handle{ *this, PooledState{ std::move(state), util::LruCache<std::uint64_t, int>{ max_loaded_scripts } } };
+}
+
+std::size_t dynser::lua::StatePool::size() const noexcept { return idle_.size(); }
+
+void dynser::lua::StatePool::release(PooledState&& pooled) noexcept
+{
+    lua_State* const raw_state = *pooled.state;
+    // error messages can be left on stack
+    lua_settop(raw_state, 0);
+    // 'inp', 'out', 'ctx', 'branch' and variables of scripts, standard library is behind __index
+    lua_pushglobaltable(raw_state);
+    clear_table(raw_state);
+    lua_pop(raw_state, 1);
+
+    idle_.push_back(std::move(pooled));
+}
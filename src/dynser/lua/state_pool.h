@@ -0,0 +1,84 @@
+#pragma once
+
+#include "luwra.hpp"
+#include "script.h"
+#include "util/lru_cache.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace dynser::lua
+{
+
+/**
+ * \brief Owns lua states with standard library and PropertyValue userdata already registered.
+ * Nested serialize calls acquire one state per nesting level, so pool size is bounded by the tags depth.
+ * \note tables of standard library are shared by all runs of state, scripts must not modify them.
+ */
+class StatePool
+{
+    struct PooledState
+    {
+        std::unique_ptr<luwra::StateWrapper> state;
+
+        // CompiledScript::id -> registry reference of loaded function
+        util::LruCache<std::uint64_t, int> loaded_scripts;
+    };
+
+public:
+    /**
+     * \brief RAII access to acquired state, returns it to the pool on destruction.
+     */
+    class Handle
+    {
+        StatePool* pool_;
+        PooledState pooled_;
+
+    public:
+        explicit Handle(StatePool& pool, PooledState&& pooled) noexcept;
+        Handle(Handle&& other) noexcept;
+        Handle(Handle const&) = delete;
+        Handle& operator=(Handle&&) = delete;
+        Handle& operator=(Handle const&) = delete;
+        ~Handle() noexcept;
+
+        luwra::StateWrapper& operator*() const noexcept { return *pooled_.state; }
+
+        luwra::StateWrapper* operator->() const noexcept { return pooled_.state.get(); }
+
+        /**
+         * \brief Run precompiled script, bytecode is loaded into the state only on first run.
+         * \return lua status code, error message left on the stack top if not LUA_OK.
+         */
+        int run(CompiledScript const& script) noexcept;
+    };
+
+    StatePool() noexcept = default;
+    // states are not shared: copy starts with empty pool
+    StatePool(StatePool const&) noexcept;
+    StatePool& operator=(StatePool const&) noexcept;
+    StatePool(StatePool&&) noexcept = default;
+    StatePool& operator=(StatePool&&) noexcept = default;
+
+    /**
+     * \brief Take idle state or create a new one.
+     */
+    [[nodiscard]] Handle acquire() noexcept;
+
+    /**
+     * \brief Count of idle states.
+     */
+    [[nodiscard]] std::size_t size() const noexcept;
+
+private:
+    /**
+     * \brief Clear all globals (standard library is kept behind their __index) and stack, then store state as idle.
+     * Globals set by scripts are visible to other scripts of same handle only.
+     */
+    void release(PooledState&& pooled) noexcept;
+
+    std::vector<PooledState> idle_{};
+};
+
+}    // namespace dynser::lua
@@ -0,0 +1,160 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace
+{
+
+// more chunks than workers, so workers finished early can steal remaining ones
+constexpr std::size_t chunks_per_worker = 4;
+
+// caller without own queue
+constexpr std::size_t no_own_queue = std::numeric_limits<std::size_t>::max();
+
+// waiting caller rechecks queues for nested tasks
+constexpr std::chrono::milliseconds help_interval{ 1 };
+
+}    // namespace
+
+dynser::parallel::ThreadPool::ThreadPool(const std::size_t threads_count) noexcept
+{
+    const auto count = std::max<std::size_t>(threads_count, 1);
+    queues_.reserve(count);
+    for (std::size_t ind{}; ind < count; ++ind) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    workers_.reserve(count);
+    for (std::size_t ind{}; ind < count; ++ind) {
+        workers_.emplace_back([this, ind] { work(ind); });
+    }
+}
+
+dynser::parallel::ThreadPool::~ThreadPool() noexcept
+{
+    {
+        std::lock_guard lock{ wake_mutex_ };
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    // join before members used by workers are destroyed
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void dynser::parallel::ThreadPool::for_each_chunk(
+    const std::size_t count,
+    const std::size_t min_chunk_size,
+    ChunkBody const& body
+) noexcept
+{
+    if (count == 0) {
+        return;
+    }
+    const auto max_chunks = size() * chunks_per_worker;
+    const auto chunk_size = std::max({ min_chunk_size, (count + max_chunks - 1) / max_chunks, std::size_t{ 1 } });
+    if (chunk_size >= count) {
+        body(0, count);
+        return;
+    }
+
+    struct Progress
+    {
+        std::mutex mutex;
+        std::condition_variable done;
+        std::size_t left;
+    };
+    // shared with tasks: last task may still hold it when caller returns
+    const auto progress = std::make_shared<Progress>();
+    progress->left = (count + chunk_size - 1) / chunk_size;
+
+    for (std::size_t begin{}; begin < count; begin += chunk_size) {
+        const auto end = std::min(begin + chunk_size, count);
+        submit([progress, &body, begin, end] {
+            body(begin, end);
+            std::lock_guard lock{ progress->mutex };
+            if (--progress->left == 0) {
+                progress->done.notify_all();
+            }
+        });
+    }
+
+    // help workers instead of blocking (tasks may be nested)
+    while (true) {
+        {
+            std::lock_guard lock{ progress->mutex };
+            if (progress->left == 0) {
+                return;
+            }
+        }
+        if (!try_run_one(no_own_queue)) {
+            std::unique_lock lock{ progress->mutex };
+            progress->done.wait_for(lock, help_interval, [&progress] { return progress->left == 0; });
+        }
+    }
+}
+
+void dynser::parallel::ThreadPool::submit(Task&& task) noexcept
+{
+    std::size_t queue_ind;
+    {
+        std::lock_guard lock{ wake_mutex_ };
+        queue_ind = next_queue_++ % queues_.size();
+        ++queued_;
+    }
+    {
+        auto& queue = *queues_[queue_ind];
+        std::lock_guard lock{ queue.mutex };
+        queue.tasks.push_back(std::move(task));
+    }
+    wake_.notify_one();
+}
+
+bool dynser::parallel::ThreadPool::try_run_one(const std::size_t own_ind) noexcept
+{
+    Task task;
+    const auto queues_count = queues_.size();
+    for (std::size_t shift{}; shift < queues_count && !task; ++shift) {
+        const auto is_own = own_ind != no_own_queue && shift == 0;
+        auto& queue = *queues_[own_ind == no_own_queue ? shift : (own_ind + shift) % queues_count];
+
+        std::lock_guard lock{ queue.mutex };
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (is_own) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+    if (!task) {
+        return false;
+    }
+    {
+        std::lock_guard lock{ wake_mutex_ };
+        --queued_;
+    }
+    task();
+    return true;
+}
+
+void dynser::parallel::ThreadPool::work(const std::size_t own_ind) noexcept
+{
+    while (true) {
+        if (try_run_one(own_ind)) {
+            continue;
+        }
+        std::unique_lock lock{ wake_mutex_ };
+        // queued task may be not pushed yet, then predicate is true and queues are checked again
+        wake_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+        if (stopping_ && queued_ == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dynser::parallel
+{
+
+/**
+ * \brief Fixed set of workers, each with own task queue: worker takes tasks from back of own queue,
+ * idle worker steals from front of others.
+ * Waiting caller runs queued tasks too, so tasks may wait for nested tasks without deadlock.
+ */
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * \brief Called for [begin, end) range of indices.
+     */
+    using ChunkBody = std::function<void(std::size_t begin, std::size_t end)>;
+
+    explicit ThreadPool(std::size_t threads_count = std::thread::hardware_concurrency()) noexcept;
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+    ~ThreadPool() noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept { return workers_.size(); }
+
+    /**
+     * \brief Split [0, count) into consecutive chunks and run body on each, returns when all chunks are done.
+     * Chunks are at least min_chunk_size long (except last one).
+     */
+    void for_each_chunk(std::size_t count, std::size_t min_chunk_size, ChunkBody const& body) noexcept;
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void submit(Task&& task) noexcept;
+
+    /**
+     * \brief Run one task from own queue (if own_ind is set) or steal one from others.
+     * \return false if all queues are empty.
+     */
+    bool try_run_one(std::size_t own_ind) noexcept;
+
+    void work(std::size_t own_ind) noexcept;
+
+    std::vector<std::unique_ptr<Queue>> queues_{};    // one per worker
+    std::vector<std::jthread> workers_{};
+
+    std::mutex wake_mutex_{};
+    std::condition_variable wake_{};
+    std::size_t queued_{};    // guarded by wake_mutex_
+    std::size_t next_queue_{};    // guarded by wake_mutex_
+    bool stopping_{};    // guarded by wake_mutex_
+};
+
+}    // namespace dynser::parallel
@@ -324,20 +324,6 @@ std::expected<std::pair<dynser::regex::Token, std::size_t>, std::size_t> parse_t
             if (!group_sus) {
                 return std::unexpected{ group_sus.error() };
             }
-            std::regex regex;
-            try {
-                regex = std::regex{ group_str.data(), group_str.size() };
-            }
-            catch (const std::regex_error& regex_error) {
-                if (regex_error.code() == std::regex_constants::error_backref) {
-                    // FIXME cases like '(([smth])\2)\1' must be handled
-                    // separately cause if we are in 1st group in this
-                    // function, then backreference \2 is invalid
-                }
-                else {
-                    return std::unexpected{ group_start };
-                }
-            }
             auto&& group = std::move(*group_sus);
             token_len += group_len + 1;    // skip ')'
             auto quantifier = search_quantifier(sv.substr(token_len), &token_len).value_or(without_quantifier);
@@ -345,7 +331,6 @@ std::expected<std::pair<dynser::regex::Token, std::size_t>, std::size_t> parse_t
                 return { { Token{ NonCapturingGroup{
                                std::make_unique<Regex>(std::move(group)),
                                std::move(quantifier),
-                               std::move(regex),
                            } },
                            token_len } };
             }
@@ -353,7 +338,6 @@ std::expected<std::pair<dynser::regex::Token, std::size_t>, std::size_t> parse_t
                 if (current_group_number) {
                     return { { Group{ std::make_unique<Regex>(std::move(group)),
                                       std::move(quantifier),
-                                      std::move(regex),
                                       *current_group_number },
                                token_len } };
                 }
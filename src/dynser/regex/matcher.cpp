@@ -0,0 +1,885 @@
+#include "matcher.h"
+
+#include "structures.h"
+#include "util/visit.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <utility>
+
+// regex::Matcher impl
+namespace
+{
+
+using dynser::regex::Matcher;
+using CharSet = Matcher::CharSet;
+using Instruction = Matcher::Instruction;
+using Type = Instruction::Type;
+
+constexpr auto infinity = std::numeric_limits<std::size_t>::max();
+constexpr auto unset = std::numeric_limits<std::size_t>::max();
+
+// [begin, end) pc of run: whole program is run until Match
+constexpr std::pair<std::uint32_t, std::uint32_t> whole_program{ 0, std::numeric_limits<std::uint32_t>::max() };
+
+// larger {n,m} quantifiers of groups and backreferences are compiled into counted loop (body is emitted once)
+constexpr std::size_t max_unrolled_count = 8;
+
+// thread backtrack stack of larger capacity is freed after run
+constexpr std::size_t max_kept_stack_size = 4096;
+
+template <typename Predicate>
+CharSet make_set(Predicate&& predicate) noexcept
+{
+    CharSet result;
+    for (std::size_t c{}; c < result.size(); ++c) {
+        if (predicate(static_cast<unsigned char>(c))) {
+            result.set(c);
+        }
+    }
+    return result;
+}
+
+// not std::isalnum etc: must not depend on locale
+const CharSet digit_set = make_set([](unsigned char c) { return c >= '0' && c <= '9'; });
+const CharSet word_set = make_set([](unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+});
+const CharSet space_set = make_set([](unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+});
+// fullstop symbol doesn't match line terminators
+const CharSet wildcard_set = ~make_set([](unsigned char c) { return c == '\n' || c == '\r'; });
+
+/**
+ * \brief Set of class escape (like '\d' or '\S'), nullptr if escape is a single character.
+ */
+CharSet const* escaped_class(const char escaped) noexcept
+{
+    static const CharSet non_digit_set = ~digit_set;
+    static const CharSet non_word_set = ~word_set;
+    static const CharSet non_space_set = ~space_set;
+
+    switch (escaped) {
+        case 'd':
+            return &digit_set;
+        case 'D':
+            return &non_digit_set;
+        case 'w':
+            return &word_set;
+        case 'W':
+            return &non_word_set;
+        case 's':
+            return &space_set;
+        case 'S':
+            return &non_space_set;
+    }
+    return nullptr;
+}
+
+/**
+ * \brief Character of single character escape (e.g. '\n' for 'n', ']' for ']').
+ */
+constexpr unsigned char unescape(const char escaped) noexcept
+{
+    switch (escaped) {
+        case 't':
+            return '\t';
+        case 'r':
+            return '\r';
+        case 'n':
+            return '\n';
+        case 'v':
+            return '\v';
+        case 'f':
+            return '\f';
+        case '0':
+            return '\0';
+    }
+    // syntax character or wrong character escaped, pass through
+    return static_cast<unsigned char>(escaped);
+}
+
+/**
+ * \brief Build set from CharacterClass::characters (raw, without brackets and negation symbol).
+ * e.g. "a-z\d_" -> [a-z0-9_]
+ */
+CharSet parse_character_class(const std::string_view chars, const bool is_negative) noexcept
+{
+    CharSet result;
+
+    // read one character (possibly escaped) at i, return nullopt if it's a class escape
+    const auto read_char = [&chars](std::size_t& i) -> std::optional<unsigned char> {
+        if (chars[i] == '\\' && i + 1 < chars.size()) {
+            if (escaped_class(chars[i + 1])) {
+                return std::nullopt;
+            }
+            i += 2;
+            return unescape(chars[i - 1]);
+        }
+        ++i;
+        return static_cast<unsigned char>(chars[i - 1]);
+    };
+
+    std::size_t i{};
+    while (i < chars.size()) {
+        const auto from_sus = read_char(i);
+        if (!from_sus) {
+            result |= *escaped_class(chars[i + 1]);
+            i += 2;
+            continue;
+        }
+        // range, '-' at the end is a literal
+        if (i + 1 < chars.size() && chars[i] == '-') {
+            auto to_pos = i + 1;
+            if (const auto to_sus = read_char(to_pos)) {
+                for (auto c = static_cast<std::size_t>(*from_sus); c <= *to_sus; ++c) {
+                    result.set(c);
+                }
+                i = to_pos;
+                continue;
+            }
+        }
+        result.set(*from_sus);
+    }
+
+    if (is_negative) {
+        result.flip();
+    }
+    return result;
+}
+
+/**
+ * \brief Capturing groups numbers in order of appearance (index in result is a capture index).
+ */
+void collect_group_numbers(dynser::regex::Regex const& reg, std::vector<std::size_t>& out) noexcept;
+
+void collect_group_numbers(dynser::regex::Token const& tok, std::vector<std::size_t>& out) noexcept
+{
+    using namespace dynser::regex;
+
+    dynser::util::visit_one(
+        tok,
+        [&out](Group const& value) {
+            out.push_back(value.number);
+            collect_group_numbers(*value.value, out);
+        },
+        [&out](NonCapturingGroup const& value) { collect_group_numbers(*value.value, out); },
+        [&out](Lookup const& value) { collect_group_numbers(*value.value, out); },
+        [&out](Disjunction const& value) {
+            collect_group_numbers(*value.left, out);
+            collect_group_numbers(*value.right, out);
+        },
+        [](auto const&) { }
+    );
+}
+
+void collect_group_numbers(dynser::regex::Regex const& reg, std::vector<std::size_t>& out) noexcept
+{
+    for (auto const& tok : reg.value) {
+        collect_group_numbers(tok, out);
+    }
+}
+
+struct Compiler
+{
+    std::vector<Instruction>& program;
+    std::vector<CharSet>& sets;
+    std::vector<std::size_t> group_numbers;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> group_bodies{};    // [begin, end) of first group value
+    std::size_t loops_count{};
+
+    std::uint32_t pc() const noexcept { return static_cast<std::uint32_t>(program.size()); }
+
+    std::uint32_t emit(Instruction&& instruction) noexcept
+    {
+        program.push_back(std::move(instruction));
+        return pc() - 1;
+    }
+
+    std::uint32_t add_set(CharSet const& set) noexcept
+    {
+        const auto found = std::find(sets.begin(), sets.end(), set);
+        if (found != sets.end()) {
+            return static_cast<std::uint32_t>(found - sets.begin());
+        }
+        sets.push_back(set);
+        return static_cast<std::uint32_t>(sets.size() - 1);
+    }
+
+    std::optional<std::uint32_t> capture_index(const std::size_t group_number) const noexcept
+    {
+        const auto found = std::find(group_numbers.begin(), group_numbers.end(), group_number);
+        if (found == group_numbers.end()) {
+            return std::nullopt;
+        }
+        return static_cast<std::uint32_t>(found - group_numbers.begin());
+    }
+
+    void compile_set(CharSet const& set, dynser::regex::Quantifier const& quantifier) noexcept
+    {
+        const auto set_ind = add_set(set);
+        if (quantifier.from == 1 && quantifier.to == 1) {
+            emit({ .type = Type::Char, .x = set_ind });
+        }
+        else {
+            emit({ .type = Type::Run,
+                   .is_lazy = quantifier.is_lazy,
+                   .x = set_ind,
+                   .min = quantifier.from,
+                   .max = quantifier.to.value_or(infinity) });
+        }
+    }
+
+    template <typename Body>
+    void compile_quantified(dynser::regex::Quantifier const& quantifier, Body&& body) noexcept
+    {
+        if (quantifier.to == 0) {
+            // never matched, but value of group is still matched by match_group
+            const auto jump = emit({ .type = Type::Jump });
+            body();
+            program[jump].x = pc();
+            return;
+        }
+        if (quantifier.to.value_or(quantifier.from) > max_unrolled_count) {
+            compile_counted(quantifier, body);
+            return;
+        }
+        for (std::size_t i{}; i < quantifier.from; ++i) {
+            body();
+        }
+        if (!quantifier.to) {
+            // L: split B, E
+            // B: loop-start; body; loop-check; jump L
+            // E:
+            const auto loop = static_cast<std::uint32_t>(loops_count++);
+            const auto split = emit({ .type = Type::Split });
+            emit({ .type = Type::LoopStart, .x = loop });
+            body();
+            emit({ .type = Type::LoopCheck, .x = loop });
+            emit({ .type = Type::Jump, .x = split });
+            program[split].x = quantifier.is_lazy ? pc() : split + 1;
+            program[split].y = quantifier.is_lazy ? split + 1 : pc();
+        }
+        else if (*quantifier.to > quantifier.from) {
+            // (body(body(body)?)?)?
+            std::vector<std::uint32_t> splits;
+            for (auto i{ quantifier.from }; i < *quantifier.to; ++i) {
+                splits.push_back(emit({ .type = Type::Split }));
+                body();
+            }
+            for (const auto split : splits) {
+                program[split].x = quantifier.is_lazy ? pc() : split + 1;
+                program[split].y = quantifier.is_lazy ? split + 1 : pc();
+            }
+        }
+    }
+
+    template <typename Body>
+    void compile_counted(dynser::regex::Quantifier const& quantifier, Body&& body) noexcept
+    {
+        //    count-start C
+        // L: count-branch C, E
+        //    loop-start R (infinite loop only); body; count-end C, R; jump L
+        // E:
+        const auto max = quantifier.to.value_or(infinity);
+        const auto counter = static_cast<std::uint32_t>(loops_count++);
+        // empty iterations are checked in infinite loop only, as in unrolled form
+        const auto loop = max == infinity ? static_cast<std::uint32_t>(loops_count++) : counter;
+        emit({ .type = Type::CountStart, .x = counter });
+        const auto branch = emit({ .type = Type::CountBranch,
+                                   .is_lazy = quantifier.is_lazy,
+                                   .x = counter,
+                                   .min = quantifier.from,
+                                   .max = max });
+        if (max == infinity) {
+            emit({ .type = Type::LoopStart, .x = loop });
+        }
+        body();
+        emit({ .type = Type::CountEnd, .x = counter, .y = loop, .min = quantifier.from, .max = max });
+        emit({ .type = Type::Jump, .x = branch });
+        program[branch].y = pc();
+    }
+
+    static void
+    flatten_disjunction(dynser::regex::Token const& tok, std::vector<dynser::regex::Token const*>& out) noexcept
+    {
+        if (auto const* disjunction = std::get_if<dynser::regex::Disjunction>(&tok)) {
+            flatten_disjunction(*disjunction->left, out);
+            flatten_disjunction(*disjunction->right, out);
+        }
+        else {
+            out.push_back(&tok);
+        }
+    }
+
+    /**
+     * \brief Compile tokens sequence with ECMAScript alternation semantics.
+     * Parser binds disjunction to adjacent tokens only ('ab|cd' is [a, b|c, d]),
+     * but std::regex splits whole sequence ('ab' or 'cd'), so alternatives are rebuilt here.
+     */
+    void compile(dynser::regex::Regex const& reg) noexcept
+    {
+        std::vector<std::vector<dynser::regex::Token const*>> alternatives(1);
+        for (auto const& tok : reg.value) {
+            if (!std::holds_alternative<dynser::regex::Disjunction>(tok)) {
+                alternatives.back().push_back(&tok);
+                continue;
+            }
+            std::vector<dynser::regex::Token const*> leaves;
+            flatten_disjunction(tok, leaves);
+            alternatives.back().push_back(leaves.front());
+            for (auto leaf = std::next(leaves.begin()); leaf != leaves.end(); ++leaf) {
+                alternatives.push_back({ *leaf });
+            }
+        }
+
+        // split A1, N1
+        // A1: alternative; jump E
+        // N1: split A2, N2
+        // ...
+        // E:
+        std::vector<std::uint32_t> jumps;
+        for (std::size_t i{}; i < alternatives.size(); ++i) {
+            const auto is_last = i + 1 == alternatives.size();
+            const auto split = is_last ? 0 : emit({ .type = Type::Split });
+            if (!is_last) {
+                program[split].x = pc();
+            }
+            for (auto const* tok : alternatives[i]) {
+                compile(*tok);
+            }
+            if (!is_last) {
+                jumps.push_back(emit({ .type = Type::Jump }));
+                program[split].y = pc();
+            }
+        }
+        for (const auto jump : jumps) {
+            program[jump].x = pc();
+        }
+    }
+
+    void compile(dynser::regex::Token const& tok) noexcept
+    {
+        using namespace dynser::regex;
+
+        dynser::util::visit_one_terminated(
+            tok,
+            [](Empty const&) { },
+            [this](WildCard const& value) { compile_set(wildcard_set, value.quantifier); },
+            [this](Group const& value) {
+                const auto capture = *capture_index(value.number);
+                compile_quantified(value.quantifier, [&] {
+                    emit({ .type = Type::Save, .x = 2 * capture });
+                    const auto begin = pc();
+                    compile(*value.value);
+                    if (group_bodies[capture].second == 0) {
+                        group_bodies[capture] = { begin, pc() };
+                    }
+                    emit({ .type = Type::Save, .x = 2 * capture + 1 });
+                });
+            },
+            [this](NonCapturingGroup const& value) {
+                compile_quantified(value.quantifier, [&] { compile(*value.value); });
+            },
+            [this](Backreference const& value) {
+                const auto capture = capture_index(value.group_number);
+                if (!capture) {
+                    // group is outside of this regex, unset groups match empty string
+                    return;
+                }
+                compile_quantified(value.quantifier, [&] {
+                    emit({ .type = Type::Backreference, .x = *capture });
+                });
+            },
+            [this](Lookup const& value) {
+                const auto lookup =
+                    emit({ .type = Type::Lookup, .is_negative = value.is_negative, .is_forward = value.is_forward });
+                program[lookup].x = lookup;
+                compile(*value.value);
+                emit({ .type = Type::Match });
+                program[lookup].y = pc();
+            },
+            [this](CharacterClass const& value) {
+                compile_set(parse_character_class(value.characters, value.is_negative), value.quantifier);
+            },
+            [this](Disjunction const& value) {
+                // unreachable: disjunctions are flattened in Regex overload
+                const auto split = emit({ .type = Type::Split });
+                program[split].x = pc();
+                compile(*value.left);
+                const auto jump = emit({ .type = Type::Jump });
+                program[split].y = pc();
+                compile(*value.right);
+                program[jump].x = pc();
+            }
+        );
+    }
+};
+
+/**
+ * \brief State to restore on backtrack.
+ */
+struct Backtrack
+{
+    enum class Type : std::uint8_t {
+        Alternative,    // continue from pc at pos
+        Restore,        // set slot x (capture or loop register) to pos, then backtrack further
+        GreedyRun,      // Run at pc from pos took x characters, try fewer of them
+        LazyRun,        // Run at pc from pos took x characters, try more of them
+    } type;
+    std::uint32_t pc{};
+    std::size_t pos{};
+    std::size_t x{};
+};
+
+struct Executor
+{
+    Instruction const* program;
+    CharSet const* sets;
+    dynser::regex::SetScanner const* scanners;
+    std::string_view subject;
+    std::size_t* captures;    // begin and end for every capture, followed by loop registers
+    std::size_t captures_size;
+    std::size_t* loops;
+    Matcher::OnMatch const* on_match;    // every match is passed to it if set
+    std::uint32_t body_end;              // Save of group value end, matched like Match (see match_group)
+    // explicit stack instead of recursion: loops over long input would overflow call stack
+    std::vector<Backtrack>& stack;
+    std::size_t lookups_depth{};    // lookup matches are never passed to on_match
+    bool hit_end{};                 // some instruction needed character after end of subject
+
+    bool contains(const std::uint32_t set_ind, const std::size_t pos) const noexcept
+    {
+        return sets[set_ind][static_cast<unsigned char>(subject[pos])];
+    }
+
+    /**
+     * \brief Pos is end of subject (so longer subject may match differently).
+     */
+    bool is_end(const std::size_t pos) noexcept
+    {
+        if (pos >= subject.size()) {
+            hit_end = true;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * \brief Run at pc, what took count characters from pos, can take one more.
+     */
+    bool can_take(const std::uint32_t pc, const std::size_t pos, const std::size_t count) noexcept
+    {
+        return count < program[pc].max && !is_end(pos + count) && contains(program[pc].x, pos + count);
+    }
+
+    /**
+     * \brief Continuation at pc can't match at pos (it starts with character what is not at pos).
+     */
+    bool is_hopeless(const std::uint32_t pc, const std::size_t pos) noexcept
+    {
+        if (program[pc].type != Type::Char) {
+            return false;
+        }
+        const auto single = scanners[program[pc].x].single();
+        return single && (is_end(pos) || static_cast<unsigned char>(subject[pos]) != *single);
+    }
+
+    /**
+     * \brief Restore state of latest alternative above stack_base.
+     * \return false if there are none (state is restored to the one at stack_base).
+     */
+    bool backtrack(const std::size_t stack_base, std::uint32_t& pc, std::size_t& pos) noexcept
+    {
+        while (stack.size() > stack_base) {
+            auto& top = stack.back();
+            switch (top.type) {
+                case Backtrack::Type::Alternative:
+                    pc = top.pc;
+                    pos = top.pos;
+                    stack.pop_back();
+                    return true;
+                case Backtrack::Type::Restore:
+                    captures[top.x] = top.pos;
+                    break;
+                case Backtrack::Type::GreedyRun:
+                    while (top.x > program[top.pc].min) {
+                        --top.x;
+                        if (!is_hopeless(top.pc + 1, top.pos + top.x)) {
+                            pc = top.pc + 1;
+                            pos = top.pos + top.x;
+                            return true;
+                        }
+                    }
+                    break;
+                case Backtrack::Type::LazyRun:
+                    while (can_take(top.pc, top.pos, top.x)) {
+                        ++top.x;
+                        if (!is_hopeless(top.pc + 1, top.pos + top.x)) {
+                            pc = top.pc + 1;
+                            pos = top.pos + top.x;
+                            return true;
+                        }
+                    }
+                    break;
+            }
+            stack.pop_back();
+        }
+        return false;
+    }
+
+    /**
+     * \brief Run greedy or lazy Run instruction at pc, push its alternatives.
+     * \return false if it can't match at pos.
+     */
+    bool run_set(std::uint32_t& pc, std::size_t& pos, const std::size_t required_end, std::size_t& match_end) noexcept
+    {
+        auto const& instruction = program[pc];
+        const auto limit = std::min(instruction.max, subject.size() - pos);
+        std::size_t count{};
+        if (instruction.is_lazy) {
+            for (; count < instruction.min; ++count) {
+                if (!can_take(pc, pos, count)) {
+                    return false;
+                }
+            }
+            while (is_hopeless(pc + 1, pos + count)) {
+                if (!can_take(pc, pos, count)) {
+                    return false;
+                }
+                ++count;
+            }
+            stack.push_back({ .type = Backtrack::Type::LazyRun, .pc = pc, .pos = pos, .x = count });
+            ++pc;
+            pos += count;
+            return true;
+        }
+        count = scanners[instruction.x].span(subject.substr(pos, limit));
+        if (count < instruction.max) {
+            is_end(pos + count);
+        }
+        if (count < instruction.min) {
+            return false;
+        }
+        // nothing to backtrack into at the end of program (unless every match is needed)
+        if (program[pc + 1].type == Type::Match && (!on_match || lookups_depth > 0)) {
+            if (required_end == unset) {
+                match_end = pos + count;
+            }
+            else if (pos + instruction.min <= required_end && required_end <= pos + count) {
+                match_end = required_end;
+            }
+            else {
+                return false;
+            }
+            pos = match_end;
+            ++pc;
+            return true;
+        }
+        while (is_hopeless(pc + 1, pos + count)) {
+            if (count == instruction.min) {
+                return false;
+            }
+            --count;
+        }
+        if (count > instruction.min) {
+            stack.push_back({ .type = Backtrack::Type::GreedyRun, .pc = pc, .pos = pos, .x = count });
+        }
+        ++pc;
+        pos += count;
+        return true;
+    }
+
+    /**
+     * \param required_end end of match, 'unset' if any.
+     * \param [out] match_end end of match if matched.
+     * \note on match state of its alternatives is dropped (captures are kept), on failure all state is restored.
+     */
+    bool run(std::uint32_t pc, std::size_t pos, const std::size_t required_end, std::size_t& match_end) noexcept
+    {
+        const auto stack_base = stack.size();
+        while (true) {
+            auto const& instruction = program[pc];
+
+            bool is_failed{};
+            switch (instruction.type) {
+                case Type::Char:
+                    if (is_end(pos) || !contains(instruction.x, pos)) {
+                        is_failed = true;
+                        break;
+                    }
+                    ++pos;
+                    ++pc;
+                    break;
+                case Type::Run:
+                    is_failed = !run_set(pc, pos, required_end, match_end);
+                    break;
+                case Type::Split:
+                    stack.push_back({ .type = Backtrack::Type::Alternative, .pc = instruction.y, .pos = pos });
+                    pc = instruction.x;
+                    break;
+                case Type::Jump:
+                    pc = instruction.x;
+                    break;
+                case Type::Save:
+                {
+                    if (pc == body_end) {
+                        if (pos != required_end) {
+                            is_failed = true;
+                            break;
+                        }
+                        match_end = pos;
+                        stack.resize(stack_base);
+                        return true;
+                    }
+                    const auto slot = std::size_t{ instruction.x };
+                    stack.push_back({ .type = Backtrack::Type::Restore, .pos = captures[slot], .x = slot });
+                    captures[slot] = pos;
+                    ++pc;
+                    break;
+                }
+                case Type::Backreference:
+                {
+                    const auto captured_begin = captures[2 * instruction.x];
+                    const auto captured_end = captures[2 * instruction.x + 1];
+                    if (captured_begin != unset && captured_end != unset && captured_begin <= captured_end) {
+                        const auto captured = subject.substr(captured_begin, captured_end - captured_begin);
+                        const auto rest = subject.substr(pos);
+                        if (!rest.starts_with(captured)) {
+                            if (captured.starts_with(rest)) {
+                                hit_end = true;
+                            }
+                            is_failed = true;
+                            break;
+                        }
+                        pos += captured.size();
+                    }
+                    ++pc;
+                    break;
+                }
+                case Type::LoopStart:
+                {
+                    const auto slot = captures_size + instruction.x;
+                    stack.push_back({ .type = Backtrack::Type::Restore, .pos = captures[slot], .x = slot });
+                    captures[slot] = pos;
+                    ++pc;
+                    break;
+                }
+                case Type::LoopCheck:
+                    // empty iteration, prevents infinite loop
+                    is_failed = loops[instruction.x] == pos;
+                    ++pc;
+                    break;
+                case Type::CountStart:
+                {
+                    const auto slot = captures_size + instruction.x;
+                    stack.push_back({ .type = Backtrack::Type::Restore, .pos = captures[slot], .x = slot });
+                    captures[slot] = 0;
+                    ++pc;
+                    break;
+                }
+                case Type::CountBranch:
+                {
+                    const auto count = loops[instruction.x];
+                    if (count < instruction.min) {
+                        ++pc;
+                    }
+                    else if (count >= instruction.max) {
+                        pc = instruction.y;
+                    }
+                    else if (instruction.is_lazy) {
+                        stack.push_back({ .type = Backtrack::Type::Alternative, .pc = pc + 1, .pos = pos });
+                        pc = instruction.y;
+                    }
+                    else {
+                        stack.push_back({ .type = Backtrack::Type::Alternative, .pc = instruction.y, .pos = pos });
+                        ++pc;
+                    }
+                    break;
+                }
+                case Type::CountEnd:
+                {
+                    const auto count = loops[instruction.x];
+                    // empty iteration above min, prevents infinite loop
+                    if (instruction.max == infinity && count >= instruction.min && loops[instruction.y] == pos) {
+                        is_failed = true;
+                        break;
+                    }
+                    const auto slot = captures_size + instruction.x;
+                    stack.push_back({ .type = Backtrack::Type::Restore, .pos = count, .x = slot });
+                    captures[slot] = count + 1;
+                    ++pc;
+                    break;
+                }
+                case Type::Lookup:
+                {
+                    // captures inside lookups are not visible outside, lookup is matched once (not backtracked into)
+                    std::vector<std::size_t> captures_backup(captures, captures + captures_size);
+                    bool is_matched{ false };
+                    std::size_t lookup_end{};
+                    ++lookups_depth;
+                    if (instruction.is_forward) {
+                        is_matched = run(instruction.x + 1, pos, unset, lookup_end);
+                    }
+                    else {
+                        for (auto start = pos + 1; !is_matched && start-- > 0;) {
+                            is_matched = run(instruction.x + 1, start, pos, lookup_end);
+                        }
+                    }
+                    --lookups_depth;
+                    std::copy(captures_backup.begin(), captures_backup.end(), captures);
+                    is_failed = is_matched == instruction.is_negative;
+                    pc = instruction.y;
+                    break;
+                }
+                case Type::Match:
+                    if (required_end != unset && pos != required_end) {
+                        is_failed = true;
+                        break;
+                    }
+                    match_end = pos;
+                    if (!on_match || lookups_depth > 0 || (*on_match)({ pos, captures })) {
+                        stack.resize(stack_base);
+                        return true;
+                    }
+                    is_failed = true;
+                    break;
+            }
+
+            if (is_failed && !backtrack(stack_base, pc, pos)) {
+                return false;
+            }
+        }
+    }
+};
+
+}    // namespace
+
+dynser::regex::Matcher::Matcher() noexcept
+  : program_{ Instruction{ .type = Instruction::Type::Match } }
+{ }
+
+dynser::regex::Matcher::Matcher(Regex const& reg) noexcept
+{
+    Compiler compiler{ program_, sets_, {} };
+    collect_group_numbers(reg, compiler.group_numbers);
+    compiler.group_bodies.resize(compiler.group_numbers.size());
+    compiler.compile(reg);
+    compiler.emit({ .type = Instruction::Type::Match });
+
+    scanners_.reserve(sets_.size());
+    for (auto const& set : sets_) {
+        scanners_.emplace_back(set);
+    }
+    captures_count_ = compiler.group_numbers.size();
+    loops_count_ = compiler.loops_count;
+    group_numbers_ = std::move(compiler.group_numbers);
+    group_bodies_ = std::move(compiler.group_bodies);
+}
+
+bool dynser::regex::Matcher::match(const std::string_view sv) const noexcept
+{
+    return run(sv, true, nullptr, nullptr, whole_program).has_value();
+}
+
+std::optional<std::size_t> dynser::regex::Matcher::match_prefix(const std::string_view sv) const noexcept
+{
+    return run(sv, false, nullptr, nullptr, whole_program);
+}
+
+bool dynser::regex::Matcher::match_prefixes(const std::string_view sv, OnMatch const& on_match) const noexcept
+{
+    return run(sv, false, &on_match, nullptr, whole_program).has_value();
+}
+
+bool dynser::regex::Matcher::match_prefixes(
+    const std::string_view sv,
+    OnMatch const& on_match,
+    bool& hit_end
+) const noexcept
+{
+    return run(sv, false, &on_match, &hit_end, whole_program).has_value();
+}
+
+bool dynser::regex::Matcher::match_group(const std::string_view sv, const std::size_t group_number) const noexcept
+{
+    const auto found = std::find(group_numbers_.begin(), group_numbers_.end(), group_number);
+    if (found == group_numbers_.end()) {
+        return false;
+    }
+    const auto capture = static_cast<std::size_t>(found - group_numbers_.begin());
+    return run(sv, true, nullptr, nullptr, group_bodies_[capture]).has_value();
+}
+
+std::optional<std::pair<std::size_t, std::size_t>>
+dynser::regex::Matcher::group_span(PrefixMatch const& match, const std::size_t group_number) const noexcept
+{
+    const auto found = std::find(group_numbers_.begin(), group_numbers_.end(), group_number);
+    if (found == group_numbers_.end()) {
+        return group_number == 0 ? std::optional{ std::pair{ std::size_t{}, match.length } } : std::nullopt;
+    }
+    const auto capture = static_cast<std::size_t>(found - group_numbers_.begin());
+    const auto begin = match.captures[2 * capture];
+    const auto end = match.captures[2 * capture + 1];
+    if (begin == unset || end == unset || begin > end) {
+        return std::nullopt;
+    }
+    return std::pair{ begin, end };
+}
+
+std::optional<std::size_t> dynser::regex::Matcher::run(
+    const std::string_view sv,
+    const bool is_full_match,
+    OnMatch const* const on_match,
+    bool* const hit_end,
+    const std::pair<std::uint32_t, std::uint32_t> body
+) const noexcept
+{
+    // slots of small programs are not allocated
+    constexpr std::size_t inline_slots_size = 32;
+    const auto slots_size = captures_count_ * 2 + loops_count_;
+    std::array<std::size_t, inline_slots_size> inline_slots;
+    std::vector<std::size_t> heap_slots;
+    auto* slots = inline_slots.data();
+    if (slots_size > inline_slots_size) {
+        heap_slots.resize(slots_size);
+        slots = heap_slots.data();
+    }
+    std::fill_n(slots, slots_size, unset);
+
+    // backtrack stack keeps its capacity between runs of thread, nested run (from on_match) uses own one
+    thread_local std::vector<Backtrack> thread_stack;
+    thread_local bool is_thread_stack_used{};
+    std::vector<Backtrack> nested_stack;
+    const auto is_nested = std::exchange(is_thread_stack_used, true);
+    auto& stack = is_nested ? nested_stack : thread_stack;
+
+    Executor executor{ .program = program_.data(),
+                       .sets = sets_.data(),
+                       .scanners = scanners_.data(),
+                       .subject = sv,
+                       .captures = slots,
+                       .captures_size = captures_count_ * 2,
+                       .loops = slots + captures_count_ * 2,
+                       .on_match = on_match,
+                       .body_end = body.second,
+                       .stack = stack };
+    std::size_t match_end{};
+    const auto is_matched = executor.run(body.first, 0, is_full_match ? sv.size() : unset, match_end);
+    if (!is_nested) {
+        stack.clear();
+        if (stack.capacity() > max_kept_stack_size) {
+            stack.shrink_to_fit();
+        }
+        is_thread_stack_used = false;
+    }
+    if (hit_end) {
+        *hit_end = executor.hit_end;
+    }
+    if (is_matched) {
+        return match_end;
+    }
+    return std::nullopt;
+}
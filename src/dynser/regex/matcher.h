@@ -0,0 +1,132 @@
+#pragma once
+
+#include "scan.h"
+
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dynser::regex
+{
+
+struct Regex;    // forward declaration (structures.h)
+
+/**
+ * \brief Backtracking program compiled from regex::Regex, replaces std::regex for group values validation.
+ * Semantics are ECMAScript-like: ordered alternatives, greedy and lazy quantifiers, backreferences to unset
+ * groups match empty string.
+ */
+class Matcher
+{
+public:
+    using CharSet = std::bitset<256>;
+
+    struct Instruction
+    {
+        enum class Type : std::uint8_t {
+            Char,             // one character from sets_[x]
+            Run,              // [min, max] characters from sets_[x]
+            Split,            // try x, then y
+            Jump,             // continue from x
+            Save,             // remember position in capture slot x
+            Backreference,    // text of capture with index x (empty if unset)
+            LoopStart,        // remember position in loop register x
+            LoopCheck,        // fail on empty iteration of loop with register x
+            CountStart,       // set iterations count in loop register x to 0
+            CountBranch,      // [min, max] iterations counted in loop register x: next one or exit to y
+            CountEnd,         // count iteration in loop register x, fail on empty one above min (position in y)
+            Lookup,           // sub-program from x + 1 to its Match, continue from y
+            Match,
+        } type;
+        bool is_lazy{};        // Run
+        bool is_negative{};    // Lookup
+        bool is_forward{};     // Lookup
+        std::uint32_t x{};
+        std::uint32_t y{};
+        std::size_t min{};
+        std::size_t max{};    // SIZE_MAX if infinite
+    };
+
+    /**
+     * \brief Match anchored at string begin, passed to match_prefixes callback.
+     */
+    struct PrefixMatch
+    {
+        std::size_t length;
+        std::size_t const* captures;    // begin and end of every capture ('unset' if not set)
+    };
+
+    // return true to accept match, false to backtrack into next one
+    using OnMatch = std::function<bool(PrefixMatch const&)>;
+
+    // matches empty string only
+    Matcher() noexcept;
+
+    explicit Matcher(Regex const& reg) noexcept;
+
+    /**
+     * \brief Check if whole string matches (like std::regex_match).
+     */
+    [[nodiscard]] bool match(std::string_view sv) const noexcept;
+
+    /**
+     * \brief Length of first match anchored at string begin (like std::regex_search with match_continuous).
+     */
+    [[nodiscard]] std::optional<std::size_t> match_prefix(std::string_view sv) const noexcept;
+
+    /**
+     * \brief Pass matches anchored at string begin to on_match in backtracking order (first one is match_prefix one)
+     * until one of them is accepted.
+     * \return false if no match is accepted.
+     */
+    bool match_prefixes(std::string_view sv, OnMatch const& on_match) const noexcept;
+
+    /**
+     * \brief Same as match_prefixes, hit_end is set if end of sv was reached while matching (before accepted match),
+     * so longer string may be matched differently. Otherwise result is the same for any continuation of sv.
+     */
+    bool match_prefixes(std::string_view sv, OnMatch const& on_match, bool& hit_end) const noexcept;
+
+    /**
+     * \brief Check if whole string matches value of group (sub-program of its first occurrence).
+     * Backreferences to groups outside of it match empty string, false if there is no such group.
+     */
+    [[nodiscard]] bool match_group(std::string_view sv, std::size_t group_number) const noexcept;
+
+    /**
+     * \brief [begin, end) of group in matched string, std::nullopt if group is not set.
+     * Group 0 is whole match if pattern is not wrapped into it.
+     */
+    [[nodiscard]] std::optional<std::pair<std::size_t, std::size_t>>
+    group_span(PrefixMatch const& match, std::size_t group_number) const noexcept;
+
+    [[nodiscard]] std::vector<Instruction> const& program() const noexcept { return program_; }
+
+    [[nodiscard]] std::vector<CharSet> const& sets() const noexcept { return sets_; }
+
+private:
+    std::vector<Instruction> program_;
+    std::vector<CharSet> sets_;
+    std::vector<SetScanner> scanners_;    // of sets_, runs of set characters are scanned by blocks
+    std::vector<std::size_t> group_numbers_;    // index is a capture index
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> group_bodies_;    // index is a capture index, [begin, end)
+    std::size_t captures_count_{};
+    std::size_t loops_count_{};
+
+    /**
+     * \param body [begin, end) of group value to match instead of whole program.
+     */
+    std::optional<std::size_t> run(
+        std::string_view sv,
+        bool is_full_match,
+        OnMatch const* on_match,
+        bool* hit_end,
+        std::pair<std::uint32_t, std::uint32_t> body
+    ) const noexcept;
+};
+
+}    // namespace dynser::regex
@@ -0,0 +1,249 @@
+#include "scan.h"
+
+#include <algorithm>
+#include <bit>
+
+// SSE2 is baseline of x86-64, AVX2 is checked on run time
+#if defined(__x86_64__) || defined(_M_X64)
+#define DYNSER_SCAN_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define DYNSER_TARGET_AVX2
+#else
+#define DYNSER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// regex::SetScanner impl
+namespace
+{
+
+using dynser::regex::ScanIsa;
+using Range = dynser::regex::SetScanner::Range;
+
+// characters checked one by one before scan by blocks: short spans are common, block setup costs more
+constexpr std::size_t min_vectorized_size = 16;
+
+/**
+ * \brief Position of first character what is in ranges (if in_ranges) or is not in them, size if there is none.
+ */
+std::size_t first_where_scalar(
+    const unsigned char* const data,
+    const std::size_t size,
+    Range const* const ranges,
+    const std::size_t count,
+    const bool in_ranges
+) noexcept
+{
+    for (std::size_t pos{}; pos < size; ++pos) {
+        bool is_in{};
+        for (std::size_t ind{}; ind < count; ++ind) {
+            is_in |= ranges[ind].from <= data[pos] && data[pos] <= ranges[ind].to;
+        }
+        if (is_in == in_ranges) {
+            return pos;
+        }
+    }
+    return size;
+}
+
+#ifdef DYNSER_SCAN_X86
+
+// c in [from, to] <=> c - from <= to - from (unsigned, wrapping)
+
+std::size_t first_where_sse2(
+    const unsigned char* const data,
+    const std::size_t size,
+    Range const* const ranges,
+    const std::size_t count,
+    const bool in_ranges
+) noexcept
+{
+    constexpr std::size_t block_size = 16;
+
+    // not std::array: attributes of vector types are ignored in template arguments
+    __m128i froms[dynser::regex::SetScanner::max_ranges];
+    __m128i widths[dynser::regex::SetScanner::max_ranges];
+    for (std::size_t ind{}; ind < count; ++ind) {
+        froms[ind] = _mm_set1_epi8(static_cast<char>(ranges[ind].from));
+        widths[ind] = _mm_set1_epi8(static_cast<char>(ranges[ind].to - ranges[ind].from));
+    }
+
+    std::size_t pos{};
+    for (; pos + block_size <= size; pos += block_size) {
+        const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        auto hits = _mm_setzero_si128();
+        for (std::size_t ind{}; ind < count; ++ind) {
+            const auto shifted = _mm_sub_epi8(block, froms[ind]);
+            hits = _mm_or_si128(hits, _mm_cmpeq_epi8(_mm_min_epu8(shifted, widths[ind]), shifted));
+        }
+        auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(hits));
+        if (!in_ranges) {
+            mask = ~mask & 0xFFFF;
+        }
+        if (mask != 0) {
+            return pos + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+    return pos + first_where_scalar(data + pos, size - pos, ranges, count, in_ranges);
+}
+
+DYNSER_TARGET_AVX2 std::size_t first_where_avx2(
+    const unsigned char* const data,
+    const std::size_t size,
+    Range const* const ranges,
+    const std::size_t count,
+    const bool in_ranges
+) noexcept
+{
+    constexpr std::size_t block_size = 32;
+
+    // not std::array: attributes of vector types are ignored in template arguments
+    __m256i froms[dynser::regex::SetScanner::max_ranges];
+    __m256i widths[dynser::regex::SetScanner::max_ranges];
+    for (std::size_t ind{}; ind < count; ++ind) {
+        froms[ind] = _mm256_set1_epi8(static_cast<char>(ranges[ind].from));
+        widths[ind] = _mm256_set1_epi8(static_cast<char>(ranges[ind].to - ranges[ind].from));
+    }
+
+    std::size_t pos{};
+    for (; pos + block_size <= size; pos += block_size) {
+        const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        auto hits = _mm256_setzero_si256();
+        for (std::size_t ind{}; ind < count; ++ind) {
+            const auto shifted = _mm256_sub_epi8(block, froms[ind]);
+            hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, widths[ind]), shifted));
+        }
+        auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(hits));
+        if (!in_ranges) {
+            mask = ~mask;
+        }
+        if (mask != 0) {
+            return pos + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+    // tail is shorter than block, SSE2 kernel takes one more block
+    return pos + first_where_sse2(data + pos, size - pos, ranges, count, in_ranges);
+}
+
+bool has_avx2() noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    // OS must save ymm registers (OSXSAVE, AVX and enabled xmm and ymm state)
+    __cpuid(info, 1);
+    constexpr int osxsave_avx = (1 << 27) | (1 << 28);
+    if ((info[2] & osxsave_avx) != osxsave_avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+ScanIsa detect_isa() noexcept
+{
+#ifdef DYNSER_SCAN_X86
+    return has_avx2() ? ScanIsa::Avx2 : ScanIsa::Sse2;
+#else
+    return ScanIsa::Scalar;
+#endif
+}
+
+}    // namespace
+
+dynser::regex::ScanIsa dynser::regex::scan_isa() noexcept
+{
+    static const auto isa = detect_isa();
+    return isa;
+}
+
+dynser::regex::SetScanner::SetScanner(CharSet const& set) noexcept
+  : set_{ set }
+{
+    if (set.count() == 1) {
+        for (std::size_t c{}; c < set.size(); ++c) {
+            if (set[c]) {
+                single_ = static_cast<unsigned char>(c);
+            }
+        }
+    }
+
+    // ranges of set or, if there are too many, of its complement
+    const auto collect_ranges = [this](CharSet const& of) {
+        ranges_count_ = 0;
+        for (std::size_t c{}; c < of.size(); ++c) {
+            if (!of[c]) {
+                continue;
+            }
+            if (ranges_count_ == max_ranges) {
+                ranges_count_ = 0;
+                return false;
+            }
+            const auto from = c;
+            while (c + 1 < of.size() && of[c + 1]) {
+                ++c;
+            }
+            ranges_[ranges_count_++] = { static_cast<unsigned char>(from), static_cast<unsigned char>(c) };
+        }
+        return ranges_count_ != 0;
+    };
+    if (!collect_ranges(set)) {
+        is_complement_ = collect_ranges(~set);
+    }
+}
+
+std::size_t dynser::regex::SetScanner::span(const std::string_view sv) const noexcept
+{
+    const auto head = head_size(sv);
+    for (std::size_t pos{}; pos < head; ++pos) {
+        if (!set_[static_cast<unsigned char>(sv[pos])]) {
+            return pos;
+        }
+    }
+    // span ends on first character out of set
+    return head == sv.size() ? head : head + first_where(sv.substr(head), is_complement_);
+}
+
+std::size_t dynser::regex::SetScanner::find(const std::string_view sv) const noexcept
+{
+    const auto head = head_size(sv);
+    for (std::size_t pos{}; pos < head; ++pos) {
+        if (set_[static_cast<unsigned char>(sv[pos])]) {
+            return pos;
+        }
+    }
+    return head == sv.size() ? head : head + first_where(sv.substr(head), !is_complement_);
+}
+
+std::size_t dynser::regex::SetScanner::head_size(const std::string_view sv) const noexcept
+{
+    if (!is_vectorized() || scan_isa() == ScanIsa::Scalar) {
+        return sv.size();
+    }
+    return std::min(sv.size(), min_vectorized_size);
+}
+
+std::size_t dynser::regex::SetScanner::first_where(const std::string_view sv, const bool in_ranges) const noexcept
+{
+    auto const* const data = reinterpret_cast<const unsigned char*>(sv.data());
+    switch (scan_isa()) {
+#ifdef DYNSER_SCAN_X86
+        case ScanIsa::Avx2:
+            return first_where_avx2(data, sv.size(), ranges_.data(), ranges_count_, in_ranges);
+        case ScanIsa::Sse2:
+            return first_where_sse2(data, sv.size(), ranges_.data(), ranges_count_, in_ranges);
+#endif
+        default:
+            return first_where_scalar(data, sv.size(), ranges_.data(), ranges_count_, in_ranges);
+    }
+}
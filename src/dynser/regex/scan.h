@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace dynser::regex
+{
+
+/**
+ * \brief Instruction set used by SetScanner, detected once on first use.
+ */
+enum class ScanIsa : std::uint8_t {
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+[[nodiscard]] ScanIsa scan_isa() noexcept;
+
+/**
+ * \brief Search of characters from set, vectorized (SSE2/AVX2) if set or its complement is a few byte ranges
+ * (like '\d', '[a-z_]' or '.'), lookup byte by byte otherwise.
+ */
+class SetScanner
+{
+public:
+    using CharSet = std::bitset<256>;
+
+    static constexpr std::size_t max_ranges = 4;
+
+    explicit SetScanner(CharSet const& set) noexcept;
+
+    /**
+     * \brief Length of prefix of sv what consists of set characters.
+     */
+    [[nodiscard]] std::size_t span(std::string_view sv) const noexcept;
+
+    /**
+     * \brief Position of first set character in sv, sv.size() if there is none.
+     */
+    [[nodiscard]] std::size_t find(std::string_view sv) const noexcept;
+
+    /**
+     * \brief Character if set consists of one character.
+     */
+    [[nodiscard]] std::optional<unsigned char> single() const noexcept { return single_; }
+
+    [[nodiscard]] bool is_vectorized() const noexcept { return ranges_count_ != 0; }
+
+    struct Range
+    {
+        unsigned char from;
+        unsigned char to;    // inclusive
+    };
+
+private:
+    /**
+     * \brief Length of sv prefix what is checked byte by byte (whole sv if set is not vectorized).
+     */
+    [[nodiscard]] std::size_t head_size(std::string_view sv) const noexcept;
+
+    /**
+     * \brief Position of first character what is in ranges_ (if in_ranges) or is not in them.
+     */
+    [[nodiscard]] std::size_t first_where(std::string_view sv, bool in_ranges) const noexcept;
+
+    CharSet set_;
+    std::array<Range, max_ranges> ranges_{};
+    std::uint8_t ranges_count_{};    // 0 if set is not vectorized
+    bool is_complement_{};           // ranges_ are ranges of set complement
+    std::optional<unsigned char> single_{};
+};
+
+}    // namespace dynser::regex
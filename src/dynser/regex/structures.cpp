@@ -5,36 +5,27 @@ namespace dynser::regex
 Group::Group(
     std::unique_ptr<Regex const>&& value,
     Quantifier&& quantifier,
-    std::regex&& regex,
     std::size_t number
 ) noexcept
   : value{ std::move(value) }
   , quantifier{ std::move(quantifier) }
-  , regex{ std::move(regex) }
   , number{ number }
 { }
 
 Group::Group(Group const& other) noexcept
   : value{ new Regex{ *other.value } }
   , quantifier{ other.quantifier }
-  , regex{ other.regex }
   , number{ other.number }
 { }
 
-NonCapturingGroup::NonCapturingGroup(
-    std::unique_ptr<Regex const>&& value,
-    Quantifier&& quantifier,
-    std::regex&& regex
-) noexcept
+NonCapturingGroup::NonCapturingGroup(std::unique_ptr<Regex const>&& value, Quantifier&& quantifier) noexcept
   : value{ std::move(value) }
   , quantifier{ std::move(quantifier) }
-  , regex{ std::move(regex) }
 { }
 
 NonCapturingGroup::NonCapturingGroup(NonCapturingGroup const& other) noexcept
   : value{ new Regex{ *other.value } }
   , quantifier{ other.quantifier }
-  , regex{ other.regex }
 { }
 
 Lookup::Lookup(std::unique_ptr<Regex const>&& value, bool is_negative, bool is_forward) noexcept
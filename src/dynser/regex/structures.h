@@ -1,8 +1,9 @@
 #pragma once
 
+#include "matcher.h"
+
 #include <memory>
 #include <optional>
-#include <regex>
 #include <string>
 #include <variant>
 
@@ -43,16 +44,12 @@ struct Group
     std::unique_ptr<struct Regex const> value;
     Quantifier quantifier;
 
-    // to vals check in regex::to_string
-    std::regex regex;
-
     // generated in regex::from_string
     std::size_t number;
 
     explicit Group(
         std::unique_ptr<struct Regex const>&& value,
         Quantifier&& quantifier,
-        std::regex&& regex,
         std::size_t number
     ) noexcept;
     Group(Group&&) noexcept = default;
@@ -64,13 +61,7 @@ struct NonCapturingGroup
     std::unique_ptr<struct Regex const> value;
     Quantifier quantifier;
 
-    std::regex regex;
-
-    explicit NonCapturingGroup(
-        std::unique_ptr<struct Regex const>&& value,
-        Quantifier&& quantifier,
-        std::regex&& regex
-    ) noexcept;
+    explicit NonCapturingGroup(std::unique_ptr<struct Regex const>&& value, Quantifier&& quantifier) noexcept;
     NonCapturingGroup(NonCapturingGroup&& other) noexcept = default;
     NonCapturingGroup(NonCapturingGroup const& other) noexcept;
 };
@@ -112,6 +103,10 @@ struct Disjunction
 struct Regex
 {
     std::vector<Token> value;
+
+    // whole pattern compiled once (see config::details::compile_regex), nullptr for values of groups.
+    // to vals check in regex::to_string: values of groups are matched by sub-programs of it
+    std::shared_ptr<Matcher const> matcher{};
 };
 
 }    // namespace dynser::regex
@@ -84,12 +84,17 @@ using CachedGroupValues = std::unordered_map<std::size_t, std::string>;
 
 dynser::regex::ToStringResult resolve_regex(
     const dynser::regex::Regex& reg,
+    const dynser::regex::Matcher& matcher,
     const ::dynser::config::yaml::GroupValues& vals,
     CachedGroupValues& cached_group_values
 ) noexcept;    // forward declaration
 
+/**
+ * \param matcher of whole pattern, values of groups are checked by it.
+ */
 dynser::regex::ToStringResult resolve_token(
     const dynser::regex::Token& tok,
+    const dynser::regex::Matcher& matcher,
     const ::dynser::config::yaml::GroupValues& vals,
     CachedGroupValues& cached_group_values
 ) noexcept
@@ -105,7 +110,7 @@ dynser::regex::ToStringResult resolve_token(
                 return std::unexpected{ ToStringError{ to_string_err::MissingValue{}, value.number } };
             }
             std::string str_group_val = vals.at(value.number);
-            if (!std::regex_match(str_group_val, value.regex)) {
+            if (!matcher.match_group(str_group_val, value.number)) {
                 if (auto appropriate_group_val = try_relent(str_group_val, *value.value)) {
                     str_group_val = std::move(*appropriate_group_val);
                 }
@@ -118,7 +123,7 @@ dynser::regex::ToStringResult resolve_token(
             return apply_quantifier(str_group_val, value.quantifier);
         },
         [&](const NonCapturingGroup& value) -> ToStringResult {
-            const auto result_sus = resolve_regex(*value.value, vals, cached_group_values);
+            const auto result_sus = resolve_regex(*value.value, matcher, vals, cached_group_values);
             if (!result_sus) {
                 return std::unexpected{ result_sus.error() };
             }
@@ -131,7 +136,9 @@ dynser::regex::ToStringResult resolve_token(
             }
             return std::unexpected{ ToStringError{ to_string_err::MissingValue{}, value.group_number } };
         },
-        [&](const Lookup& value) -> ToStringResult { return resolve_regex(*value.value, vals, cached_group_values); },
+        [&](const Lookup& value) -> ToStringResult {
+            return resolve_regex(*value.value, matcher, vals, cached_group_values);
+        },
         [&](const CharacterClass& value) -> ToStringResult {
             // Get most left character and make it actual value
 
@@ -202,13 +209,14 @@ dynser::regex::ToStringResult resolve_token(
             return apply_quantifier(std::string(1, result_char), value.quantifier);
         },
         [&](const Disjunction& value) -> ToStringResult {
-            return resolve_token(*value.left, vals, cached_group_values);
+            return resolve_token(*value.left, matcher, vals, cached_group_values);
         }
     );
 }
 
 dynser::regex::ToStringResult resolve_regex(
     const dynser::regex::Regex& reg,
+    const dynser::regex::Matcher& matcher,
     const ::dynser::config::yaml::GroupValues& vals,
     CachedGroupValues& cached_group_values
 ) noexcept
@@ -217,7 +225,7 @@ dynser::regex::ToStringResult resolve_regex(
 
     std::string result;
     for (const auto& token : reg.value) {
-        if (const auto str_sus = resolve_token(token, vals, cached_group_values)) {
+        if (const auto str_sus = resolve_token(token, matcher, vals, cached_group_values)) {
             result += *str_sus;
         }
         else {
@@ -233,5 +241,10 @@ dynser::regex::ToStringResult
 dynser::regex::to_string(const Regex& reg, const dynser::config::yaml::GroupValues& vals) noexcept
 {
     CachedGroupValues cached_group_values;    // for backreferences
-    return ::resolve_regex(reg, vals, cached_group_values);
+    if (reg.matcher) {
+        return ::resolve_regex(reg, *reg.matcher, vals, cached_group_values);
+    }
+    // regex is not compiled by config::details::compile_regex
+    const Matcher matcher{ reg };
+    return ::resolve_regex(reg, matcher, vals, cached_group_values);
 }
@@ -1,6 +1,7 @@
 #pragma once
 
-#include <map>
+#include "util/flat_map.hpp"
+
 #include <string>
 
 namespace dynser
@@ -9,6 +10,6 @@ namespace dynser
 /**
  * \brief Named parts of string, what can be converted and projected into type fields.
  */
-using Fields = std::map<std::string, std::string>;
+using Fields = util::FlatMap<std::string, std::string>;
 
 }    // namespace dyn_ser
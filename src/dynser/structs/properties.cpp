@@ -1,5 +1,98 @@
 #include "properties.h"
 
+#include <algorithm>
+#include <optional>
+
+namespace
+{
+
+std::optional<dynser::PropertyValue> read_property_value(luwra::State* state, int index) noexcept
+{
+    using dynser::PropertyValue;
+
+    index = lua_absindex(state, index);
+    switch (lua_type(state, index)) {
+        case LUA_TBOOLEAN:
+            return PropertyValue{ static_cast<bool>(lua_toboolean(state, index)) };
+        case LUA_TNUMBER:
+            if (lua_isinteger(state, index)) {
+                return PropertyValue{ static_cast<std::int64_t>(lua_tointeger(state, index)) };
+            }
+            return PropertyValue{ static_cast<PropertyValue::FloatType>(lua_tonumber(state, index)) };
+        case LUA_TSTRING:
+        {
+            std::size_t size{};
+            const char* const data = lua_tolstring(state, index, &size);
+            return PropertyValue{ PropertyValue::StringType{ data, size } };
+        }
+        case LUA_TTABLE:
+        {
+            const auto size = static_cast<lua_Integer>(lua_rawlen(state, index));
+            if (size == 0) {
+                return PropertyValue{ dynser::read_properties(state, index) };
+            }
+            PropertyValue::ListType<PropertyValue> result;
+            result.reserve(static_cast<std::size_t>(size));
+            for (lua_Integer ind{ 1 }; ind <= size; ++ind) {
+                lua_rawgeti(state, index, ind);
+                if (auto value = read_property_value(state, -1)) {
+                    result.push_back(std::move(*value));
+                }
+                lua_pop(state, 1);
+            }
+            return PropertyValue{ std::move(result) };
+        }
+    }
+    return std::nullopt;
+}
+
+// integer accessor for scripts: lua integers are read as i64, so value of any integer type is converted to
+// requested one, value that doesn't fit is reported as lua error instead of being wrapped
+template <auto to>
+int lua_integer_as(luwra::State* state)
+{
+    auto const& value = luwra::read<dynser::PropertyValue&>(state, 1);
+    const auto result = (value.*to)();
+    if (!result) {
+        return luaL_error(state, "property value is not an integer or is out of requested type range");
+    }
+    lua_pushinteger(state, static_cast<lua_Integer>(*result));
+    return 1;
+}
+
+}    // namespace
+
+void dynser::PropertyValue::materialize() noexcept
+{
+    if (is_string_view()) {
+        data_.emplace<StringType>(as_const_string_view());
+    }
+    else if (is_list()) {
+        for (auto& value : as_list()) {
+            value.materialize();
+        }
+    }
+    else if (is_map()) {
+        dynser::materialize(as_map());
+    }
+}
+
+bool dynser::PropertyValue::has_views() const noexcept
+{
+    if (is_string_view()) {
+        return true;
+    }
+    if (is_list()) {
+        auto const& list = std::get<ListType<PropertyValue>>(data_);
+        return std::ranges::any_of(list, [](auto const& value) { return value.has_views(); });
+    }
+    if (is_map()) {
+        auto const& map = std::get<Properties>(data_);
+        return std::ranges::any_of(map, [](auto const& entry) { return entry.second.has_views(); });
+    }
+    return false;
+}
+
 dynser::Properties dynser::operator<<(dynser::Properties&& lhs, dynser::Properties&& rhs) noexcept
 {
     lhs.merge(rhs);
@@ -18,10 +111,10 @@ void dynser::register_userdata_property_value(luwra::StateWrapper& state) noexce
         // members
         {
             // as
-            LUWRA_MEMBER(dynser::PropertyValue, as_i32),
-            LUWRA_MEMBER(dynser::PropertyValue, as_i64),
-            LUWRA_MEMBER(dynser::PropertyValue, as_u32),
-            LUWRA_MEMBER(dynser::PropertyValue, as_u64),
+            { "as_i32", &lua_integer_as<&dynser::PropertyValue::to_i32> },
+            { "as_i64", &lua_integer_as<&dynser::PropertyValue::to_i64> },
+            { "as_u32", &lua_integer_as<&dynser::PropertyValue::to_u32> },
+            { "as_u64", &lua_integer_as<&dynser::PropertyValue::to_u64> },
             LUWRA_MEMBER(dynser::PropertyValue, as_float),
             LUWRA_MEMBER(dynser::PropertyValue, as_string),
             LUWRA_MEMBER(dynser::PropertyValue, as_bool),
@@ -44,3 +137,43 @@ void dynser::register_userdata_property_value(luwra::StateWrapper& state) noexce
         {}
     );
 }
+
+dynser::Properties dynser::read_properties(luwra::State* state, int index) noexcept
+{
+    index = lua_absindex(state, index);
+    Properties result;
+    if (lua_type(state, index) != LUA_TTABLE) {
+        return result;
+    }
+    lua_pushnil(state);
+    while (lua_next(state, index) != 0) {
+        // lua_tolstring on non-string key would break lua_next
+        if (lua_type(state, -2) == LUA_TSTRING) {
+            if (auto value = read_property_value(state, -1)) {
+                std::size_t size{};
+                const char* const key = lua_tolstring(state, -2, &size);
+                result.insert_or_assign(std::string{ key, size }, std::move(*value));
+            }
+        }
+        lua_pop(state, 1);    // keep key for next iteration
+    }
+    return result;
+}
+
+void dynser::push_property_value(luwra::State* state, PropertyValue const& value) noexcept
+{
+    if (!value.has_views()) {
+        luwra::push(state, value);
+        return;
+    }
+    auto owned = value;
+    owned.materialize();
+    luwra::push(state, owned);
+}
+
+void dynser::materialize(Properties& props) noexcept
+{
+    for (auto& [key, value] : props) {
+        value.materialize();
+    }
+}
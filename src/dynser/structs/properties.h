@@ -1,39 +1,60 @@
 #pragma once
 
 #include "luwra.hpp"
+#include "util/flat_map.hpp"
 
-#include <any>
 #include <cassert>
 #include <cstdint>
-#include <map>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 
 namespace dynser
 {
 
 /**
  * \brief Named parts of type, what can be converted and projected to string.
- * \note luwra's register_user_type can't receive std::unoredered_maps.
+ * \note pushed to lua as table (see luwra::Value specialization below).
  */
-using Properties = std::map<std::string, struct PropertyValue>;
+using Properties = util::FlatMap<std::string, struct PropertyValue>;
 
 /**
  * \brief Property value type, can be used in lua.
- * std::any wrapper with constant type.
+ * Tagged union of closed types set with constant type.
  */
 struct PropertyValue
 {
-private:
-    std::any data_;
-
-public:
     using FloatType = double;
     using CharType = char;
     using StringType = std::string;
+    // points into deserialized string (see deserialize::CaptureMode::View), not passed to lua
+    using StringViewType = std::string_view;
     using MapKeyType = std::string;
     template <typename T>
     using ListType = std::vector<T>;
 
+private:
+    // std::monostate if value is not set
+    std::variant<
+        std::monostate,
+        std::int32_t,
+        std::int64_t,
+        std::uint32_t,
+        std::uint64_t,
+        FloatType,
+        StringType,
+        StringViewType,
+        bool,
+        CharType,
+        ListType<PropertyValue>,
+        Properties>
+        data_;
+
+public:
     // ========================================================================
     // ===                           CONSTRUCTORS                           ===
     // ========================================================================
@@ -45,7 +66,7 @@ public:
     // trivial one-argument ctor macro
 #define DYNSER_POPULATE_PROPERTY_VALUE(type)                                                                           \
     inline explicit PropertyValue(type value) noexcept                                                                 \
-      : data_{ value }                                                                                                 \
+      : data_{ std::in_place_type<type>, std::move(value) }                                                            \
     { }
 
     DYNSER_POPULATE_PROPERTY_VALUE(std::int32_t)
@@ -54,10 +75,11 @@ public:
     DYNSER_POPULATE_PROPERTY_VALUE(std::uint64_t)
     DYNSER_POPULATE_PROPERTY_VALUE(FloatType)
     DYNSER_POPULATE_PROPERTY_VALUE(StringType)
+    DYNSER_POPULATE_PROPERTY_VALUE(StringViewType)
 
     // construct from string literal
     inline explicit PropertyValue(CharType const* value) noexcept
-      : data_{ StringType{ value } }
+      : data_{ std::in_place_type<StringType>, value }
     { }
 
     DYNSER_POPULATE_PROPERTY_VALUE(bool)
@@ -76,7 +98,7 @@ private:
     template <typename T>
     inline decltype(auto) is() const noexcept
     {
-        return typeid(T) == data_.type();
+        return std::holds_alternative<T>(data_);
     }
 
 public:
@@ -89,6 +111,7 @@ public:
     DYNSER_POPULATE_IS(is_u64, std::uint64_t)
     DYNSER_POPULATE_IS(is_float, FloatType)
     DYNSER_POPULATE_IS(is_string, StringType)
+    DYNSER_POPULATE_IS(is_string_view, StringViewType)
     DYNSER_POPULATE_IS(is_bool, bool)
     DYNSER_POPULATE_IS(is_char, CharType)
     DYNSER_POPULATE_IS(is_list, ListType<PropertyValue>)
@@ -107,7 +130,7 @@ private:
     inline decltype(auto) as_const() const
     {
         assert(is<T>());    // FIXME make out parameter optional?
-        return std::any_cast<const T&>(data_);
+        return std::get<T>(data_);
     }
 
 public:
@@ -120,6 +143,7 @@ public:
     DYNSER_POPULATE_AS_CONST(as_const_u64, std::uint64_t)
     DYNSER_POPULATE_AS_CONST(as_const_float, FloatType)
     DYNSER_POPULATE_AS_CONST(as_const_string, StringType)
+    DYNSER_POPULATE_AS_CONST(as_const_string_view, StringViewType)
     DYNSER_POPULATE_AS_CONST(as_const_bool, bool)
     DYNSER_POPULATE_AS_CONST(as_const_char, CharType)
     DYNSER_POPULATE_AS_CONST(as_const_list, ListType<PropertyValue>)
@@ -134,11 +158,17 @@ public:
 private:
     // base method
     // modify data of object instance
+    // viewed string is materialized by as_string
     template <typename T>
     inline decltype(auto) as()
     {
+        if constexpr (std::is_same_v<T, StringType>) {
+            if (is<StringViewType>()) {
+                materialize();
+            }
+        }
         assert(is<T>());    // FIXME make out parameter optional?
-        return std::any_cast<T&>(data_);
+        return std::get<T>(data_);
     }
 
 public:
@@ -151,12 +181,61 @@ public:
     DYNSER_POPULATE_AS(as_u64, std::uint64_t)
     DYNSER_POPULATE_AS(as_float, FloatType)
     DYNSER_POPULATE_AS(as_string, StringType)
+    DYNSER_POPULATE_AS(as_string_view, StringViewType)
     DYNSER_POPULATE_AS(as_bool, bool)
     DYNSER_POPULATE_AS(as_char, CharType)
     DYNSER_POPULATE_AS(as_list, ListType<PropertyValue>)
     DYNSER_POPULATE_AS(as_map, Properties)
 
 #undef DYNSER_POPULATE_AS
+
+    // ========================================================================
+    // ===                           'TO' method                            ===
+    // ========================================================================
+
+private:
+    // base method
+    // integer of any integer type converted to T (e.g. lua integers are read as i64),
+    // std::nullopt if value is not integer or is out of T range
+    template <typename T>
+    inline std::optional<T> to() const noexcept
+    {
+        return std::visit(
+            [](auto const& value) -> std::optional<T> {
+                using Stored = std::remove_cvref_t<decltype(value)>;
+                if constexpr (std::is_integral_v<Stored> && !std::is_same_v<Stored, bool> &&
+                              !std::is_same_v<Stored, CharType>)
+                {
+                    if (std::in_range<T>(value)) {
+                        return static_cast<T>(value);
+                    }
+                }
+                return std::nullopt;
+            },
+            data_
+        );
+    }
+
+public:
+#define DYNSER_POPULATE_TO(name, type)                                                                                 \
+    inline std::optional<type> name() const noexcept { return to<type>(); }
+
+    DYNSER_POPULATE_TO(to_i32, std::int32_t)
+    DYNSER_POPULATE_TO(to_i64, std::int64_t)
+    DYNSER_POPULATE_TO(to_u32, std::uint32_t)
+    DYNSER_POPULATE_TO(to_u64, std::uint64_t)
+
+#undef DYNSER_POPULATE_TO
+
+    /**
+     * \brief Copy viewed string (and ones in nested lists and maps) into owned one.
+     */
+    void materialize() noexcept;
+
+    /**
+     * \brief Value is (or nested lists and maps contain) viewed string.
+     */
+    [[nodiscard]] bool has_views() const noexcept;
 };
 
 Properties operator<<(Properties&& lhs, Properties&& rhs) noexcept;
@@ -165,7 +244,74 @@ Properties operator<<(Properties&& lhs, Properties const& rhs) noexcept;
 
 void register_userdata_property_value(luwra::StateWrapper& state) noexcept;
 
+/**
+ * \brief Read lua table (e.g. deserialization script output) as properties.
+ * Booleans, integers, other numbers and strings are read as bool, i64, float and string values,
+ * tables with [1] element as lists, other tables as maps. Other values (and non-string map keys) are skipped.
+ */
+Properties read_properties(luwra::State* state, int index) noexcept;
+
+/**
+ * \brief Copy viewed strings of properties into owned ones, so deserialized string may be freed.
+ */
+void materialize(Properties& props) noexcept;
+
+/**
+ * \brief Push value to lua as userdata, viewed strings are pushed as owned ones (lua accessors expect them).
+ */
+void push_property_value(luwra::State* state, PropertyValue const& value) noexcept;
+
 }    // namespace dynser
 
+namespace luwra
+{
+
+/**
+ * \brief Same as luwra's std::map conversion: table with keys and values converted one by one.
+ */
+template <typename Key, typename Type>
+struct Value<dynser::util::FlatMap<Key, Type>>
+{
+    static inline dynser::util::FlatMap<Key, Type> read(State* state, int index)
+    {
+        dynser::util::FlatMap<Key, Type> result;
+        read_into(state, index, result);
+        return result;
+    }
+
+    /**
+     * \brief Same as read, but result is cleared and refilled (its buffer is reused).
+     */
+    static inline void read_into(State* state, int index, dynser::util::FlatMap<Key, Type>& result)
+    {
+        index = lua_absindex(state, index);
+        luaL_checktype(state, index, LUA_TTABLE);
+
+        result.clear();
+        lua_pushnil(state);
+        while (lua_next(state, index) != 0) {
+            result.insert_or_assign(luwra::read<Key>(state, -2), luwra::read<Type>(state, -1));
+            lua_pop(state, 1);    // keep key for next iteration
+        }
+    }
+
+    static inline void push(State* state, dynser::util::FlatMap<Key, Type> const& map)
+    {
+        lua_createtable(state, 0, static_cast<int>(map.size()));
+        for (auto const& [key, value] : map) {
+            luwra::push(state, key);
+            if constexpr (std::is_same_v<Type, dynser::PropertyValue>) {
+                dynser::push_property_value(state, value);
+            }
+            else {
+                luwra::push(state, value);
+            }
+            lua_rawset(state, -3);
+        }
+    }
+};
+
+}    // namespace luwra
+
 // FIXME link errors
 // LUWRA_DEF_REGISTRY_NAME(dynser::PropertyValue, "PropertyValue")
@@ -0,0 +1,189 @@
+#include "properties_view.h"
+
+#include "util/prefix.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace
+{
+
+using Entry = dynser::PropertiesView::Entry;
+
+bool entry_less(Entry const& lhs, Entry const& rhs) noexcept { return lhs.key < rhs.key; }
+
+}    // namespace
+
+dynser::PropertiesView::PropertiesView(Properties const& props) noexcept
+{
+    entries_.reserve(props.size());
+    for (auto const& [key, value] : props) {
+        entries_.push_back({ key, &value });
+    }
+}
+
+dynser::PropertiesView::PropertiesView(std::vector<Entry>&& sorted_entries) noexcept
+  : entries_{ std::move(sorted_entries) }
+{ }
+
+dynser::PropertyValue const* dynser::PropertiesView::find(const std::string_view key) const noexcept
+{
+    const auto found = std::lower_bound(entries_.begin(), entries_.end(), Entry{ key, nullptr }, &entry_less);
+    return found != entries_.end() && found->key == key ? found->value : nullptr;
+}
+
+bool dynser::PropertiesView::contains(const std::string_view key) const noexcept { return find(key) != nullptr; }
+
+dynser::PropertyValue const& dynser::PropertiesView::at(const std::string_view key) const
+{
+    if (const auto* const value = find(key)) {
+        return *value;
+    }
+    throw std::out_of_range{ "PropertiesView::at" };
+}
+
+std::vector<Entry> dynser::PropertiesView::remove_prefix(const std::string_view prefix) const noexcept
+{
+    const auto infix_size = std::string_view{ util::infix }.size();
+
+    // keys with same prefix are adjacent in sorted entries
+    std::vector<Entry> result;
+    for (auto it = std::lower_bound(entries_.begin(), entries_.end(), Entry{ prefix, nullptr }, &entry_less);
+         it != entries_.end() && it->key.starts_with(prefix);
+         ++it)
+    {
+        if (it->key.size() >= prefix.size() + infix_size) {
+            result.push_back({ it->key.substr(prefix.size() + infix_size), it->value });
+        }
+    }
+    // 'a@c' and 'ab@c' both start with 'a', so stripped keys are not sorted
+    std::stable_sort(result.begin(), result.end(), &entry_less);
+    // first of equal keys is kept (as Properties::insert does)
+    result.erase(
+        std::unique(
+            result.begin(), result.end(), [](Entry const& lhs, Entry const& rhs) { return lhs.key == rhs.key; }
+        ),
+        result.end()
+    );
+    return result;
+}
+
+dynser::PropertiesView
+dynser::PropertiesView::scoped(const std::optional<std::string_view> prefix, const std::string_view tag) const noexcept
+{
+    const PropertiesView without_prefix = prefix ? PropertiesView{ remove_prefix(*prefix) } : *this;
+    const auto tag_scoped = without_prefix.remove_prefix(tag);
+
+    // tag-scoped entries take precedence
+    std::vector<Entry> result;
+    result.reserve(tag_scoped.size() + without_prefix.size());
+    std::set_union(
+        tag_scoped.begin(),
+        tag_scoped.end(),
+        without_prefix.entries_.begin(),
+        without_prefix.entries_.end(),
+        std::back_inserter(result),
+        &entry_less
+    );
+    return PropertiesView{ std::move(result) };
+}
+
+dynser::PropertiesView dynser::PropertiesView::non_lists() const noexcept
+{
+    std::vector<Entry> result;
+    result.reserve(entries_.size());
+    std::copy_if(entries_.begin(), entries_.end(), std::back_inserter(result), [](Entry const& entry) {
+        return !entry.value->is_list();
+    });
+    return PropertiesView{ std::move(result) };
+}
+
+dynser::PropertiesView dynser::PropertiesView::lists() const noexcept
+{
+    std::vector<Entry> result;
+    std::copy_if(entries_.begin(), entries_.end(), std::back_inserter(result), [](Entry const& entry) {
+        return entry.value->is_list();
+    });
+    return PropertiesView{ std::move(result) };
+}
+
+dynser::PropertiesView dynser::PropertiesView::list_elements(const std::size_t ind) const noexcept
+{
+    PropertiesView result;
+    list_elements(ind, result);
+    return result;
+}
+
+void dynser::PropertiesView::list_elements(const std::size_t ind, PropertiesView& out) const noexcept
+{
+    out.entries_.clear();
+    for (auto const& [key, value] : entries_) {
+        if (value->is_list() && value->as_const_list().size() > ind) {
+            out.entries_.push_back({ key, &value->as_const_list()[ind] });
+        }
+    }
+}
+
+dynser::Properties dynser::PropertiesView::to_properties() const noexcept
+{
+    Properties result;
+    result.reserve(entries_.size());
+    for (auto const& [key, value] : entries_) {
+        result.try_emplace(std::string{ key }, *value);
+    }
+    return result;
+}
+
+dynser::PropertyValue const* dynser::OverlaidPropertiesView::find(const std::string_view key) const noexcept
+{
+    if (const auto* const value = overlay_->find(key)) {
+        return value;
+    }
+    return base_->find(key);
+}
+
+bool dynser::OverlaidPropertiesView::contains(const std::string_view key) const noexcept
+{
+    return find(key) != nullptr;
+}
+
+dynser::PropertyValue const& dynser::OverlaidPropertiesView::at(const std::string_view key) const
+{
+    if (const auto* const value = find(key)) {
+        return *value;
+    }
+    throw std::out_of_range{ "OverlaidPropertiesView::at" };
+}
+
+dynser::PropertiesView dynser::OverlaidPropertiesView::merged() const noexcept
+{
+    if (overlay_->empty()) {
+        return *base_;
+    }
+    // overlay entries take precedence
+    std::vector<Entry> result;
+    result.reserve(overlay_->size() + base_->size());
+    std::set_union(
+        overlay_->begin(),
+        overlay_->end(),
+        base_->begin(),
+        base_->end(),
+        std::back_inserter(result),
+        &entry_less
+    );
+    return PropertiesView{ std::move(result) };
+}
+
+dynser::PropertiesView dynser::OverlaidPropertiesView::scoped(
+    const std::optional<std::string_view> prefix,
+    const std::string_view tag
+) const noexcept
+{
+    return merged().scoped(prefix, tag);
+}
+
+dynser::Properties dynser::OverlaidPropertiesView::to_properties() const noexcept
+{
+    return merged().to_properties();
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "properties.h"
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace dynser
+{
+
+/**
+ * \brief Non-owning sorted view of properties, keys and values point into viewed Properties.
+ * Used to pass scoped (prefix-stripped) properties to nested rules without copying values.
+ * \note viewed Properties must outlive view.
+ */
+class PropertiesView
+{
+public:
+    struct Entry
+    {
+        std::string_view key;
+        PropertyValue const* value;
+    };
+
+    using const_iterator = std::vector<Entry>::const_iterator;
+
+    PropertiesView() noexcept = default;
+
+    explicit PropertiesView(Properties const& props) noexcept;
+
+    [[nodiscard]] const_iterator begin() const noexcept { return entries_.begin(); }
+
+    [[nodiscard]] const_iterator end() const noexcept { return entries_.end(); }
+
+    [[nodiscard]] std::size_t size() const noexcept { return entries_.size(); }
+
+    [[nodiscard]] bool empty() const noexcept { return entries_.empty(); }
+
+    /**
+     * \return nullptr if key not found.
+     */
+    [[nodiscard]] PropertyValue const* find(std::string_view key) const noexcept;
+
+    [[nodiscard]] bool contains(std::string_view key) const noexcept;
+
+    /**
+     * \throw std::out_of_range if key not found (like Properties::at).
+     */
+    [[nodiscard]] PropertyValue const& at(std::string_view key) const;
+
+    /**
+     * \brief Properties of existing rule: 'prefix@' removed (if set),
+     * then 'tag@key' properties replace 'key' ones.
+     * Same as `remove_prefix(p, tag) << p` where `p = remove_prefix(props, prefix)`.
+     */
+    [[nodiscard]] PropertiesView scoped(std::optional<std::string_view> prefix, std::string_view tag) const noexcept;
+
+    /**
+     * \brief Properties what are not lists.
+     */
+    [[nodiscard]] PropertiesView non_lists() const noexcept;
+
+    /**
+     * \brief Properties what are lists.
+     */
+    [[nodiscard]] PropertiesView lists() const noexcept;
+
+    /**
+     * \brief ind-th elements of list properties under list keys, shorter lists are skipped.
+     * Elements are not copied, view points into viewed lists.
+     */
+    [[nodiscard]] PropertiesView list_elements(std::size_t ind) const noexcept;
+
+    /**
+     * \brief Same as list_elements(ind), but out is refilled (its buffer is reused).
+     * Cheap if called on lists() view: only list properties are visited.
+     */
+    void list_elements(std::size_t ind, PropertiesView& out) const noexcept;
+
+    /**
+     * \brief Copy viewed properties (e.g. to store in error).
+     */
+    [[nodiscard]] Properties to_properties() const noexcept;
+
+private:
+    friend class OverlaidPropertiesView;
+
+    explicit PropertiesView(std::vector<Entry>&& sorted_entries) noexcept;
+
+    /**
+     * \brief Entries with keys starting with prefix, prefix and infix removed from keys.
+     */
+    std::vector<Entry> remove_prefix(std::string_view prefix) const noexcept;
+
+    std::vector<Entry> entries_{};    // sorted by key
+};
+
+/**
+ * \brief Properties view with overlay on top, overlay properties hide base ones with same key.
+ * Used for elements of recurrent rules: lookups go through both layers, merged view is built
+ * only when nested (existing) rule needs its own scoped view.
+ * \note base and overlay must outlive view.
+ */
+class OverlaidPropertiesView
+{
+    PropertiesView const* base_;
+    PropertiesView const* overlay_;
+
+public:
+    OverlaidPropertiesView(PropertiesView const& base, PropertiesView const& overlay) noexcept
+      : base_{ &base }
+      , overlay_{ &overlay }
+    { }
+
+    /**
+     * \return nullptr if key not found.
+     */
+    [[nodiscard]] PropertyValue const* find(std::string_view key) const noexcept;
+
+    [[nodiscard]] bool contains(std::string_view key) const noexcept;
+
+    /**
+     * \throw std::out_of_range if key not found.
+     */
+    [[nodiscard]] PropertyValue const& at(std::string_view key) const;
+
+    /**
+     * \brief Same as PropertiesView::scoped of merged layers.
+     */
+    [[nodiscard]] PropertiesView scoped(std::optional<std::string_view> prefix, std::string_view tag) const noexcept;
+
+    [[nodiscard]] PropertiesView merged() const noexcept;
+
+    [[nodiscard]] Properties to_properties() const noexcept;
+};
+
+}    // namespace dynser
+
+namespace luwra
+{
+
+/**
+ * \brief Pushed as table, like Properties.
+ */
+template <>
+struct Value<dynser::PropertiesView>
+{
+    static inline void push(State* state, dynser::PropertiesView const& view)
+    {
+        lua_createtable(state, 0, static_cast<int>(view.size()));
+        for (auto const& [key, value] : view) {
+            lua_pushlstring(state, key.data(), key.size());
+            dynser::push_property_value(state, *value);
+            lua_rawset(state, -3);
+        }
+    }
+};
+
+}    // namespace luwra
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace dynser::util
+{
+
+/**
+ * \brief Sorted vector with std::map interface (only what is used by Properties and Fields).
+ * Keys are compared with transparent comparator, so lookup by std::string_view or literal doesn't allocate.
+ * \note iterators are invalidated by any insertion or erasure.
+ */
+template <typename Key, typename T, typename Compare = std::less<>>
+class FlatMap
+{
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using size_type = std::size_t;
+    using container_type = std::vector<value_type>;
+    using iterator = typename container_type::iterator;
+    using const_iterator = typename container_type::const_iterator;
+
+private:
+    container_type data_{};
+    [[no_unique_address]] Compare compare_{};
+
+    template <typename K>
+    iterator lower_bound_impl(K const& key) noexcept
+    {
+        return std::lower_bound(data_.begin(), data_.end(), key, [this](value_type const& entry, K const& k) {
+            return compare_(entry.first, k);
+        });
+    }
+
+    template <typename K>
+    const_iterator lower_bound_impl(K const& key) const noexcept
+    {
+        return std::lower_bound(data_.begin(), data_.end(), key, [this](value_type const& entry, K const& k) {
+            return compare_(entry.first, k);
+        });
+    }
+
+    template <typename It, typename K>
+    bool is_key_at(It const it, K const& key) const noexcept
+    {
+        return it != data_.end() && !compare_(key, it->first);
+    }
+
+public:
+    FlatMap() noexcept = default;
+
+    FlatMap(std::initializer_list<value_type> init)
+      : FlatMap(init.begin(), init.end())
+    { }
+
+    template <typename InputIt>
+    FlatMap(InputIt first, InputIt last)
+    {
+        insert(first, last);
+    }
+
+    // ========================================================================
+    // ===                            CAPACITY                              ===
+    // ========================================================================
+
+    [[nodiscard]] bool empty() const noexcept { return data_.empty(); }
+
+    [[nodiscard]] size_type size() const noexcept { return data_.size(); }
+
+    void reserve(const size_type new_cap) { data_.reserve(new_cap); }
+
+    void clear() noexcept { data_.clear(); }
+
+    // ========================================================================
+    // ===                            ITERATORS                             ===
+    // ========================================================================
+
+    iterator begin() noexcept { return data_.begin(); }
+
+    iterator end() noexcept { return data_.end(); }
+
+    const_iterator begin() const noexcept { return data_.begin(); }
+
+    const_iterator end() const noexcept { return data_.end(); }
+
+    const_iterator cbegin() const noexcept { return data_.cbegin(); }
+
+    const_iterator cend() const noexcept { return data_.cend(); }
+
+    // ========================================================================
+    // ===                              LOOKUP                              ===
+    // ========================================================================
+
+    template <typename K>
+    iterator find(K const& key) noexcept
+    {
+        const auto it = lower_bound_impl(key);
+        return is_key_at(it, key) ? it : data_.end();
+    }
+
+    template <typename K>
+    const_iterator find(K const& key) const noexcept
+    {
+        const auto it = lower_bound_impl(key);
+        return is_key_at(it, key) ? it : data_.end();
+    }
+
+    template <typename K>
+    [[nodiscard]] bool contains(K const& key) const noexcept
+    {
+        return is_key_at(lower_bound_impl(key), key);
+    }
+
+    template <typename K>
+    [[nodiscard]] size_type count(K const& key) const noexcept
+    {
+        return contains(key) ? 1 : 0;
+    }
+
+    template <typename K>
+    T& at(K const& key)
+    {
+        const auto it = find(key);
+        if (it == data_.end()) {
+            throw std::out_of_range{ "FlatMap::at" };
+        }
+        return it->second;
+    }
+
+    template <typename K>
+    T const& at(K const& key) const
+    {
+        const auto it = find(key);
+        if (it == data_.end()) {
+            throw std::out_of_range{ "FlatMap::at" };
+        }
+        return it->second;
+    }
+
+    T& operator[](Key const& key) { return try_emplace(key).first->second; }
+
+    T& operator[](Key&& key) { return try_emplace(std::move(key)).first->second; }
+
+    // ========================================================================
+    // ===                            MODIFIERS                             ===
+    // ========================================================================
+
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args)
+    {
+        const auto it = lower_bound_impl(key);
+        if (is_key_at(it, key)) {
+            return { it, false };
+        }
+        return { data_.emplace(
+                     it,
+                     std::piecewise_construct,
+                     std::forward_as_tuple(std::forward<K>(key)),
+                     std::forward_as_tuple(std::forward<Args>(args)...)
+                 ),
+                 true };
+    }
+
+    template <typename K, typename M>
+    std::pair<iterator, bool> insert_or_assign(K&& key, M&& value)
+    {
+        const auto it = lower_bound_impl(key);
+        if (is_key_at(it, key)) {
+            it->second = std::forward<M>(value);
+            return { it, false };
+        }
+        return { data_.emplace(it, std::forward<K>(key), std::forward<M>(value)), true };
+    }
+
+    std::pair<iterator, bool> insert(value_type const& value) { return try_emplace(value.first, value.second); }
+
+    std::pair<iterator, bool> insert(value_type&& value)
+    {
+        return try_emplace(std::move(value.first), std::move(value.second));
+    }
+
+    /**
+     * \brief Insert range, already existing keys (and repeated keys in range) are not overwritten.
+     */
+    template <typename InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        const auto old_size = data_.size();
+        data_.insert(data_.end(), first, last);
+        // stable: existing and earlier inserted values come first among equal keys
+        std::stable_sort(data_.begin() + old_size, data_.end(), [this](value_type const& l, value_type const& r) {
+            return compare_(l.first, r.first);
+        });
+        std::inplace_merge(
+            data_.begin(),
+            data_.begin() + old_size,
+            data_.end(),
+            [this](value_type const& l, value_type const& r) { return compare_(l.first, r.first); }
+        );
+        const auto new_end =
+            std::unique(data_.begin(), data_.end(), [this](value_type const& l, value_type const& r) {
+                return !compare_(l.first, r.first) && !compare_(r.first, l.first);
+            });
+        data_.erase(new_end, data_.end());
+    }
+
+    void insert(std::initializer_list<value_type> init) { insert(init.begin(), init.end()); }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        return insert(value_type(std::forward<Args>(args)...));
+    }
+
+    iterator erase(const_iterator pos) { return data_.erase(pos); }
+
+    iterator erase(iterator pos) { return data_.erase(pos); }
+
+    template <typename K>
+    size_type erase(K const& key)
+    {
+        const auto it = find(key);
+        if (it == data_.end()) {
+            return 0;
+        }
+        data_.erase(it);
+        return 1;
+    }
+
+    /**
+     * \brief Move entries with keys not present in this map from source (like std::map::merge).
+     */
+    void merge(FlatMap& source)
+    {
+        container_type merged;
+        container_type left_in_source;
+        merged.reserve(data_.size() + source.data_.size());
+
+        auto own = data_.begin();
+        auto other = source.data_.begin();
+        while (own != data_.end() || other != source.data_.end()) {
+            if (other == source.data_.end() || (own != data_.end() && compare_(own->first, other->first))) {
+                merged.push_back(std::move(*own++));
+            }
+            else if (own == data_.end() || compare_(other->first, own->first)) {
+                merged.push_back(std::move(*other++));
+            }
+            else {
+                // same key, own value wins
+                merged.push_back(std::move(*own++));
+                left_in_source.push_back(std::move(*other++));
+            }
+        }
+
+        data_ = std::move(merged);
+        source.data_ = std::move(left_in_source);
+    }
+
+    void merge(FlatMap&& source) { merge(source); }
+
+    friend bool operator==(FlatMap const& lhs, FlatMap const& rhs) noexcept { return lhs.data_ == rhs.data_; }
+};
+
+}    // namespace dynser::util
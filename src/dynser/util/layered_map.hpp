@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdexcept>
+
+namespace dynser::util
+{
+
+/**
+ * \brief Read-only lookup through two maps, front map keys hide back map ones.
+ * Provides only what is used by details::merge_maps (contains and at), nothing is copied.
+ * \note both maps must outlive layered map.
+ */
+template <typename Map>
+class LayeredMap
+{
+    Map const* front_;
+    Map const* back_;
+
+public:
+    using key_type = typename Map::key_type;
+    using mapped_type = typename Map::mapped_type;
+
+    LayeredMap(Map const& front, Map const& back) noexcept
+      : front_{ &front }
+      , back_{ &back }
+    { }
+
+    template <typename K>
+    [[nodiscard]] bool contains(K const& key) const noexcept
+    {
+        return front_->contains(key) || back_->contains(key);
+    }
+
+    /**
+     * \throw std::out_of_range if key not found in both maps.
+     */
+    template <typename K>
+    mapped_type const& at(K const& key) const
+    {
+        if (const auto found = front_->find(key); found != front_->end()) {
+            return found->second;
+        }
+        if (const auto found = back_->find(key); found != back_->end()) {
+            return found->second;
+        }
+        throw std::out_of_range{ "LayeredMap::at" };
+    }
+};
+
+}    // namespace dynser::util
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <unordered_map>
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <utility>
+
+namespace dynser::util
+{
+
+/**
+ * \brief Map with limited size, least recently used entry is dropped on overflow.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache
+{
+    using Entries = std::list<std::pair<Key, Value>>;
+
+    std::size_t capacity_;
+    Entries entries_{};    // most recently used first
+    std::unordered_map<Key, typename Entries::iterator, Hash> index_{};
+
+    void rebuild_index() noexcept
+    {
+        index_.clear();
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            index_.emplace(it->first, it);
+        }
+    }
+
+public:
+    explicit LruCache(const std::size_t capacity) noexcept
+      : capacity_{ capacity }
+    { }
+
+    LruCache(LruCache const& other) noexcept
+      : capacity_{ other.capacity_ }
+      , entries_{ other.entries_ }
+    {
+        rebuild_index();
+    }
+
+    LruCache& operator=(LruCache const& other) noexcept
+    {
+        if (this != &other) {
+            capacity_ = other.capacity_;
+            entries_ = other.entries_;
+            rebuild_index();
+        }
+        return *this;
+    }
+
+    LruCache(LruCache&&) noexcept = default;
+    LruCache& operator=(LruCache&&) noexcept = default;
+
+    /**
+     * \brief Find value and mark it as recently used.
+     * \return nullptr if not found, pointer is valid until next insert.
+     */
+    [[nodiscard]] Value const* find(Key const& key) noexcept
+    {
+        const auto found = index_.find(key);
+        if (found == index_.end()) {
+            return nullptr;
+        }
+        entries_.splice(entries_.begin(), entries_, found->second);
+        return &found->second->second;
+    }
+
+    /**
+     * \brief Insert or replace value.
+     * \return inserted value, reference is valid until next insert.
+     */
+    Value const& insert(Key const& key, Value&& value) noexcept
+    {
+        return insert(key, std::move(value), [](Key const&, Value const&) noexcept { });
+    }
+
+    /**
+     * \brief Insert or replace value, on_drop is called with each replaced or evicted entry.
+     * \return inserted value, reference is valid until next insert.
+     */
+    template <typename OnDrop>
+    Value const& insert(Key const& key, Value&& value, OnDrop&& on_drop) noexcept
+    {
+        if (const auto found = index_.find(key); found != index_.end()) {
+            on_drop(found->second->first, found->second->second);
+            entries_.erase(found->second);
+            index_.erase(found);
+        }
+        entries_.emplace_front(key, std::move(value));
+        index_.emplace(key, entries_.begin());
+        while (entries_.size() > capacity_ && entries_.size() > 1) {
+            on_drop(entries_.back().first, entries_.back().second);
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+        return entries_.front().second;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return entries_.size(); }
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+};
+
+}    // namespace dynser::util
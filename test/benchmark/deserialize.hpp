@@ -0,0 +1,86 @@
+#include "dynser.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+#include <string>
+#include <thread>
+
+TEST_CASE("Deserialize")
+{
+    using namespace dynser;
+
+    DynSer ser{};
+    {
+        const auto config =
+#include "../configs/benchmark_serialize.yaml.raw"
+            ;
+        REQUIRE(ser.load_config(config::RawContents{ config }));
+    }
+
+    // fields without deserialization script are not passed to lua
+    BENCHMARK("Tag: literal")
+    {
+        const auto result = ser.deserialize_to_props("[ lorem ipsum) to: (,  ]", "literal");
+        REQUIRE(result);
+        return result;
+    };
+
+    BENCHMARK("Tag: minimal-lua")
+    {
+        const auto result = ser.deserialize_to_props("lorem ipsum", "minimal-lua");
+        REQUIRE(result);
+        return result;
+    };
+
+    std::string list;
+    for (std::size_t ind{}; ind < 100'000; ++ind) {
+        list += ind == 0 ? "42" : ", 42";
+    }
+
+    // '\d+' alternatives are enumerated only on backtrack
+    BENCHMARK("Tag: recurrent-list")
+    {
+        const auto result = ser.deserialize_to_props(list, "recurrent-list");
+        REQUIRE(result);
+        return result;
+    };
+}
+
+TEST_CASE("Parallel deserialize")
+{
+    using namespace dynser;
+
+    DynSer ser{};
+    {
+        const auto config =
+#include "../configs/benchmark_serialize.yaml.raw"
+            ;
+        REQUIRE(ser.load_config(config::RawContents{ config }));
+    }
+
+    // ~10 MB, every element is stored in properties, so input much longer mostly measures allocations
+    std::string list;
+    for (std::size_t ind{}; ind < 2'500'000; ++ind) {
+        list += ind == 0 ? "42" : ", 42";
+    }
+
+    BENCHMARK("Tag: recurrent-list, 10 MB sequentially")
+    {
+        const auto result = ser.deserialize_to_props(list, "recurrent-list");
+        REQUIRE(result);
+        return result;
+    };
+
+    // waiting caller runs chunks too, so 'n threads' is n workers and caller
+    const auto max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        ser.set_thread_pool(std::make_shared<parallel::ThreadPool>(threads));
+        BENCHMARK("Tag: recurrent-list, 10 MB, " + std::to_string(threads) + " threads")
+        {
+            const auto result = ser.deserialize_to_props(list, "recurrent-list");
+            REQUIRE(result);
+            return result;
+        };
+    }
+}
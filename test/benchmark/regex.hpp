@@ -0,0 +1,136 @@
+#include "dynser.h"
+#include "regex/scan.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/**
+ * \brief Catch2 reports time only, throughput of best of few runs is printed as warning.
+ */
+template <typename Scan>
+void report_throughput(const std::string_view name, const std::size_t bytes, Scan const& scan)
+{
+    constexpr std::size_t runs = 5;
+    auto best = std::chrono::duration<double>::max();
+    for (std::size_t ind{}; ind < runs; ++ind) {
+        const auto start = std::chrono::steady_clock::now();
+        volatile auto result = scan();
+        static_cast<void>(result);
+        best = std::min<std::chrono::duration<double>>(best, std::chrono::steady_clock::now() - start);
+    }
+    WARN(name << ": " << static_cast<double>(bytes) / best.count() / 1e9 << " GB/s");
+}
+
+}    // namespace
+
+TEST_CASE("Regex scan")
+{
+    using namespace dynser;
+
+    constexpr std::size_t size = 16 << 20;
+    const std::string digits(size, '7');
+    std::string words;
+    for (std::size_t ind{}; ind < size; ++ind) {
+        words += static_cast<char>('a' + ind % 26);
+    }
+
+    const auto reg_of = [](std::string_view pattern) {
+        const auto reg = regex::from_string(pattern);
+        REQUIRE(reg);
+        return regex::Matcher{ *reg };
+    };
+    const auto digits_matcher = reg_of("\\d+");
+    const auto words_matcher = reg_of("[a-z]+");
+    const auto line_matcher = reg_of(".*");
+    const regex::SetScanner digit_scanner{ digits_matcher.sets().front() };
+
+    // what matcher did before scanning by blocks
+    BENCHMARK("span '\\d', 16 MiB, byte by byte")
+    {
+        auto const& set = digits_matcher.sets().front();
+        std::size_t count{};
+        while (count < digits.size() && set[static_cast<unsigned char>(digits[count])]) {
+            ++count;
+        }
+        return count;
+    };
+
+    BENCHMARK("span '\\d', 16 MiB")
+    {
+        return digit_scanner.span(digits);
+    };
+
+    BENCHMARK("match '\\d+', 16 MiB")
+    {
+        return digits_matcher.match(digits);
+    };
+
+    BENCHMARK("match '[a-z]+', 16 MiB")
+    {
+        return words_matcher.match(words);
+    };
+
+    BENCHMARK("match '.*', 16 MiB")
+    {
+        return line_matcher.match(words);
+    };
+
+    report_throughput("span '\\d' byte by byte", size, [&] {
+        auto const& set = digits_matcher.sets().front();
+        std::size_t count{};
+        while (count < digits.size() && set[static_cast<unsigned char>(digits[count])]) {
+            ++count;
+        }
+        return count;
+    });
+    report_throughput("span '\\d'", size, [&] { return digit_scanner.span(digits); });
+    report_throughput("match '[a-z]+'", size, [&] { return words_matcher.match(words); });
+    report_throughput("match '.*'", size, [&] { return line_matcher.match(words); });
+}
+
+TEST_CASE("Regex match short")
+{
+    using namespace dynser;
+
+    // cost of run itself (slots and backtrack stack are not allocated per run)
+    const auto reg = regex::from_string("(\\w+)=(\\d+)");
+    REQUIRE(reg);
+    const regex::Matcher matcher{ *reg };
+
+    std::vector<std::string> inputs;
+    for (std::size_t ind{}; ind < 1000; ++ind) {
+        inputs.push_back("key" + std::to_string(ind) + "=" + std::to_string(ind * 7));
+    }
+
+    BENCHMARK("match '(\\w+)=(\\d+)', 1000 short strings")
+    {
+        std::size_t matched{};
+        for (auto const& input : inputs) {
+            matched += matcher.match(input);
+        }
+        return matched;
+    };
+}
+
+TEST_CASE("Split elements")
+{
+    std::string list;
+    for (std::size_t ind{}; ind < 1'000'000; ++ind) {
+        list += ind == 0 ? "( 1, 2 )" : ", ( 1, 2 )";
+    }
+
+    BENCHMARK("split '( 1, 2 ), ...', 10 MB")
+    {
+        return dynser::deserialize::split_elements(list, ", ");
+    };
+
+    report_throughput("split '( 1, 2 ), ...'", list.size(), [&] {
+        return dynser::deserialize::split_elements(list, ", ")->size();
+    });
+}
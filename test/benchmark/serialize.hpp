@@ -3,6 +3,8 @@
 #include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
+#include <thread>
+
 TEST_CASE("Serialize")
 {
     using namespace dynser;
@@ -52,6 +54,7 @@ TEST_CASE("Serialize")
 
         DYNSER_BENCHMARK_SERIALIZE_PROPS(ser, Properties{}, "continual-without-fields", Context{});
         DYNSER_BENCHMARK_SERIALIZE_PROPS(ser, Properties{}, "empty", Context{});
+        DYNSER_BENCHMARK_SERIALIZE_PROPS(ser, Properties{}, "literal", Context{});
         DYNSER_BENCHMARK_SERIALIZE_PROPS(ser, util::map_to_props("value", "lorem ipsum"), "minimal-lua", Context{});
         DYNSER_BENCHMARK_SERIALIZE_PROPS(
             ser, util::map_to_props("len-expander", List(100ull, PropertyValue{ "" })), "recurrent-empty", Context{}
@@ -63,6 +66,116 @@ TEST_CASE("Serialize")
             Context{}
         );
 
+        // output buffer is reserved once by estimated size
+        DYNSER_BENCHMARK_SERIALIZE_PROPS(
+            ser,
+            util::map_to_props("value", List(100'000ull, PropertyValue{ 42 })),
+            "recurrent-list",
+            Context{}
+        );
+
 #undef DYNSER_BANCHMARK_SERIALIZE_PROPS
     }
+
+    // batch of same-tag records: tag is resolved and lua state is acquired once
+    {
+        const std::vector<Properties> records(1'000ull, util::map_to_props("value", "lorem ipsum"));
+
+        BENCHMARK("Tag: minimal-lua, 1000 records one by one")
+        {
+            std::string out;
+            for (const auto& record : records) {
+                REQUIRE(ser.serialize_props_to(out, record, "minimal-lua"));
+            }
+            return out;
+        };
+
+        BENCHMARK("Tag: minimal-lua, 1000 records batch")
+        {
+            const auto result = ser.serialize_batch(records, "minimal-lua");
+            REQUIRE(result);
+            return result;
+        };
+    }
+}
+
+TEST_CASE("Parallel batch")
+{
+    using namespace dynser;
+
+    DynSer ser{};
+    {
+        const auto config =
+#include "../configs/benchmark_serialize.yaml.raw"
+            ;
+        REQUIRE(ser.load_config(config::RawContents{ config }));
+    }
+
+    const std::vector<Properties> records(10'000ull, util::map_to_props("value", "lorem ipsum"));
+
+    BENCHMARK("Tag: minimal-lua, 10000 records sequentially")
+    {
+        return ser.serialize_batch_parallel(records, "minimal-lua");
+    };
+
+    // waiting caller runs chunks too, so 'n threads' is n workers and caller
+    const auto max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        ser.set_thread_pool(std::make_shared<parallel::ThreadPool>(threads));
+        BENCHMARK("Tag: minimal-lua, 10000 records, " + std::to_string(threads) + " threads")
+        {
+            return ser.serialize_batch_parallel(records, "minimal-lua");
+        };
+    }
+}
+
+TEST_CASE("Lua state")
+{
+    using namespace dynser;
+
+    // what serialize_props paid on every call before pooling
+    BENCHMARK("fresh state")
+    {
+        luwra::StateWrapper state;
+        state.loadStandardLibrary();
+        register_userdata_property_value(state);
+        state[config::keywords::CONTEXT] = Context{};
+        return static_cast<lua_State*>(state);
+    };
+
+    lua::StatePool pool;
+    {
+        // warm up
+        const auto handle = pool.acquire();
+    }
+    REQUIRE(pool.size() == 1);
+
+    BENCHMARK("pooled state")
+    {
+        const auto handle = pool.acquire();
+        (*handle)[config::keywords::CONTEXT] = Context{};
+        return static_cast<lua_State*>(*handle);
+    };
+}
+
+TEST_CASE("Properties")
+{
+    using namespace dynser;
+
+    using List = PropertyValue::ListType<PropertyValue>;
+
+    const auto props = util::map_to_props(
+        "value", 42, "name", "lorem ipsum", "list", List(100ull, PropertyValue{ 1.5 }), "flag", true
+    );
+
+    BENCHMARK("copy") { return Properties{ props }; };
+
+    BENCHMARK("type check")
+    {
+        std::size_t floats{};
+        for (auto const& value : props.at("list").as_const_list()) {
+            floats += value.is_float();
+        }
+        return floats;
+    };
 }
@@ -1,6 +1,8 @@
 // make one target with all tests
 
 // clang-format off
+#include "deserialize.hpp"
+#include "regex.hpp"
 #include "serialize.hpp"
 // clang-format on
 
@@ -0,0 +1,85 @@
+#include "common.hpp"
+
+#include <string>
+
+TEST_CASE("Capture mode")
+{
+    using namespace dynser;
+
+    DynSer ser{};
+
+    const auto config = R"##(---
+version: ''
+tags:
+  - name: "pos"
+    continual:
+      - linear: { pattern: '(-?\d+), (-?\d+)', fields: { 1: x, 2: y } }
+  - name: "pos-list"
+    recurrent:
+      - linear: { pattern: '\( ' }
+      - existing: { tag: "pos" }
+      - linear: { pattern: ' \)' }
+      - infix: { pattern: ', ' }
+  - name: "scripted-pos"
+    continual:
+      - linear: { pattern: '(-?\d+), (-?\d+)', fields: { 1: x, 2: y } }
+    deserialization-script: |
+      out['x'] = tonumber(inp['x'])
+      out['y'] = inp['y']
+  - name: "echo-pos"
+    continual:
+      - linear: { pattern: '(-?\d+), (-?\d+)', fields: { 1: x, 2: y } }
+    serialization-script: |
+      out['x'] = inp['x']:is_string() and inp['x']:as_string() or '?'
+      out['y'] = inp['y']:as_string()
+...)##";
+
+    DYNSER_LOAD_CONFIG(ser, config::RawContents{ config });
+
+    const std::string input{ "( 1, 2 ), ( -3, 4 )" };
+    const auto is_in_input = [&input](std::string_view value) {
+        return value.data() >= input.data() && value.data() + value.size() <= input.data() + input.size();
+    };
+
+    SECTION("copy")
+    {
+        const auto result = ser.deserialize_to_props(input, "pos-list");
+        REQUIRE(result);
+        CHECK(result->at("x").as_const_list()[1].as_const_string() == "-3");
+    }
+
+    SECTION("view")
+    {
+        auto result = ser.deserialize_to_props(input, "pos-list", deserialize::CaptureMode::View);
+        REQUIRE(result);
+        auto const& xs = result->at("x").as_const_list();
+        REQUIRE(xs.size() == 2);
+        REQUIRE(xs[1].is_string_view());
+        CHECK(xs[1].as_const_string_view() == "-3");
+        CHECK(is_in_input(xs[1].as_const_string_view()));
+
+        materialize(*result);
+        REQUIRE(result->at("y").as_const_list()[0].is_string());
+        CHECK(result->at("y").as_const_list()[0].as_const_string() == "2");
+    }
+
+    SECTION("view with script")
+    {
+        // values set by script are copied out of lua
+        const auto result = ser.deserialize_to_props("5, 6", "scripted-pos", deserialize::CaptureMode::View);
+        REQUIRE(result);
+        CHECK(result->at("x").as_const_i64() == 5);
+        CHECK(result->at("y").as_const_string() == "6");
+    }
+
+    SECTION("view serialized back")
+    {
+        // scripts get owned strings
+        const auto result = ser.deserialize_to_props("7, 8", "echo-pos", deserialize::CaptureMode::View);
+        REQUIRE(result);
+        REQUIRE(result->at("x").is_string_view());
+        const auto serialized = ser.serialize_props(*result, "echo-pos");
+        REQUIRE(serialized);
+        CHECK(*serialized == "7, 8");
+    }
+}
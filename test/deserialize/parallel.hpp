@@ -0,0 +1,79 @@
+#include "common.hpp"
+
+#include <memory>
+#include <string>
+
+TEST_CASE("Parallel deserialization")
+{
+    using namespace dynser;
+
+    DynSer ser{};
+
+    const auto config = R"##(---
+version: ''
+tags:
+  - name: "pos"
+    continual:
+      - linear: { pattern: '(-?\d+), (-?\d+)', fields: { 1: x, 2: y } }
+  - name: "pos-list"
+    recurrent:
+      - linear: { pattern: '\( ' }
+      - existing: { tag: "pos" }
+      - linear: { pattern: ' \)' }
+      - infix: { pattern: ', ' }
+  - name: "any-list"
+    recurrent:
+      - linear: { pattern: '(.+)', fields: { 1: value } }
+      - infix: { pattern: ', ' }
+...)##";
+
+    DYNSER_LOAD_CONFIG(ser, config::RawContents{ config });
+    ser.set_thread_pool(std::make_shared<parallel::ThreadPool>(4));
+
+    // long enough to be split, separators inside brackets are skipped
+    constexpr std::size_t count = 10'000;
+    std::string input;
+    for (std::size_t ind{}; ind < count; ++ind) {
+        input += (ind == 0 ? "( " : ", ( ") + std::to_string(ind) + ", -" + std::to_string(ind) + " )";
+    }
+
+    SECTION("elements are in order")
+    {
+        const auto result = ser.deserialize_to_props(input, "pos-list");
+        REQUIRE(result);
+        auto const& xs = result->at("x").as_const_list();
+        auto const& ys = result->at("y").as_const_list();
+        REQUIRE(xs.size() == count);
+        REQUIRE(ys.size() == count);
+        CHECK(xs[1234].as_const_string() == "1234");
+        CHECK(ys[count - 1].as_const_string() == "-" + std::to_string(count - 1));
+    }
+
+    SECTION("errors are the same as in sequential deserialization")
+    {
+        auto invalid = input;
+        invalid.replace(invalid.find("( 5000,"), 2, "(5");
+        const auto result = ser.deserialize_to_props(invalid, "pos-list");
+        REQUIRE_FALSE(result);
+
+        ser.set_thread_pool(nullptr);
+        const auto sequential = ser.deserialize_to_props(invalid, "pos-list");
+        REQUIRE_FALSE(sequential);
+        REQUIRE(std::holds_alternative<deserialize_err::NoMatch>(result.error().error));
+        CHECK(
+            std::get<deserialize_err::NoMatch>(result.error().error).position ==
+            std::get<deserialize_err::NoMatch>(sequential.error().error).position
+        );
+        CHECK(result.error().scope_string == sequential.error().scope_string);
+    }
+
+    SECTION("element may contain separator")
+    {
+        // input isn't split, so whole input is one element
+        const auto result = ser.deserialize_to_props(input, "any-list");
+        REQUIRE(result);
+        auto const& values = result->at("value").as_const_list();
+        REQUIRE(values.size() == 1);
+        CHECK(values[0].as_const_string() == input);
+    }
+}
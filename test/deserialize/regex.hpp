@@ -13,6 +13,7 @@ auto regex_to_string(dynser::regex::Token const& value) -> std::string;
 auto regex_to_string(dynser::regex::Regex const& value) -> std::string;
 
 auto props_to_quantifier(dynser::Properties const& value) -> dynser::regex::Quantifier;
+auto props_to_token(dynser::Properties const& value) -> dynser::regex::Token;
 auto props_to_regex(dynser::Properties const& value) -> dynser::regex::Regex;
 
 TEST_CASE("Regex")
@@ -173,14 +174,75 @@ auto regex_to_string(dynser::regex::Regex const& value) -> std::string
 auto props_to_quantifier(dynser::Properties const& value) -> dynser::regex::Quantifier
 {
     return {
-        value.at("from").as_const_u64(),
-        value.contains("to") ? std::optional{ value.at("to").as_const_u64() } : std::nullopt,
-        value.at("is_lazy").as_const_bool(),
+        value.at("from").to_u64().value(),
+        value.contains("to") ? value.at("to").to_u64() : std::nullopt,
+        value.at("is-lazy").as_const_bool(),
     };
 }
 
+auto props_to_token(dynser::Properties const& value) -> dynser::regex::Token
+{
+    using namespace dynser::regex;
+    using dynser::util::remove_prefix;
+
+    const auto inner = [&value] {
+        return std::make_unique<Regex const>(props_to_regex(remove_prefix(value, "inner")));
+    };
+
+    auto const& type = value.at("type").as_const_string();
+    if (type == "group") {
+        // group number is not used by regex_to_string
+        return Group{ inner(), props_to_quantifier(value), 0 };
+    }
+    if (type == "non-capturing-group") {
+        return NonCapturingGroup{ inner(), props_to_quantifier(value) };
+    }
+    if (type == "backreference") {
+        return Backreference{
+            .group_number = value.at("group-number").to_u64().value(),
+            .quantifier = props_to_quantifier(value),
+        };
+    }
+    if (type == "lookup") {
+        return Lookup{ inner(), value.at("is-negative").as_const_bool(), value.at("is-forward").as_const_bool() };
+    }
+    if (type == "character-class") {
+        auto const& characters = value.at("characters").as_const_string();
+        const auto is_negative = value.at("is-negative").as_const_bool();
+        if (characters == "." && !is_negative) {
+            return WildCard{ props_to_quantifier(value) };
+        }
+        return CharacterClass{
+            .characters = characters,
+            .is_negative = is_negative,
+            .quantifier = props_to_quantifier(value),
+        };
+    }
+    if (type == "disjunction") {
+        return Disjunction{
+            std::make_unique<Token const>(props_to_token(remove_prefix(value, "left"))),
+            std::make_unique<Token const>(props_to_token(remove_prefix(value, "right"))),
+        };
+    }
+    return Empty{};
+}
+
 auto props_to_regex(dynser::Properties const& value) -> dynser::regex::Regex
 {
-    // FIXME
-    return {};
+    using dynser::util::remove_prefix;
+
+    dynser::regex::Regex result;
+    for (auto const& token : value.at("value").as_const_list()) {
+        auto const& props = token.as_const_map();
+        // nested regex token is flattened
+        if (props.at("type").as_const_string() == "regex") {
+            for (auto&& nested : props_to_regex(remove_prefix(props, "value")).value) {
+                result.value.push_back(std::move(nested));
+            }
+        }
+        else {
+            result.value.push_back(props_to_token(props));
+        }
+    }
+    return result;
 }
@@ -1,6 +1,8 @@
 // make one target with all tests
 
 // clang-format off
+#include "capture_mode.hpp"
+#include "parallel.hpp"
 #include "regex.hpp"
 // clang-format on
 
@@ -0,0 +1,329 @@
+#include "config/config.h"
+#include "deserialize/program.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include <map>
+#include <string>
+
+namespace
+{
+
+// fields are passed as is, branch is passed as 'branch' property
+dynser::deserialize::ScriptResult pass_fields(dynser::deserialize::ScriptCall const& call)
+{
+    dynser::Properties result;
+    for (auto const& [name, value] : call.fields) {
+        result.insert_or_assign(std::string{ name }, dynser::PropertyValue{ std::string{ value } });
+    }
+    if (call.branch) {
+        result.insert_or_assign("branch", dynser::PropertyValue{ static_cast<std::int64_t>(*call.branch) });
+    }
+    return result;
+}
+
+// flat string and i64 properties sorted by name, or error position
+std::string dump(dynser::deserialize::RunResult const& result)
+{
+    if (!result) {
+        return "error at " + std::to_string(result.error().position);
+    }
+    std::map<std::string, std::string> sorted;
+    for (auto const& [name, value] : *result) {
+        sorted[name] = value.is_string() ? value.as_const_string() : std::to_string(value.as_const_i64());
+    }
+    std::string dumped;
+    for (auto const& [name, value] : sorted) {
+        dumped += name + '=' + value + ';';
+    }
+    return dumped;
+}
+
+dynser::regex::Matcher const* no_dyn_patterns(dynser::deserialize::Program::Linear const&) { return nullptr; }
+
+}    // namespace
+
+TEST_CASE("Deserialize program")
+{
+    using dynser::PropertyValue;
+    using dynser::deserialize::Program;
+
+    const auto config = dynser::config::from_string(R"(
+version: ''
+tags:
+  - name: "pos-list"
+    continual:
+      - linear: { pattern: '\[ ' }
+      - existing: { tag: "pos-list-payload" }
+      - linear: { pattern: ' \]' }
+  - name: "pos-list-payload"
+    recurrent:
+      - linear: { pattern: '\( ' }
+      - existing: { tag: "pos" }
+      - linear: { pattern: ' \)' }
+      - infix: { pattern: ', ' }
+  - name: "pos"
+    continual:
+      - linear: { pattern: '(-?\d+), (-?\d+)', fields: { 1: x, 2: y } }
+  - name: "input"
+    continual:
+      - existing: { tag: "pos", prefix: "from" }
+      - linear: { pattern: ' -> ' }
+      - existing: { tag: "pos", prefix: "to" }
+  - name: "greedy"
+    continual:
+      - linear: { pattern: '(a+)', fields: { 1: a } }
+      - linear: { pattern: 'ab' }
+  - name: "halves"
+    continual:
+      - linear: { pattern: '(a+)', fields: { 1: a } }
+      - linear: { pattern: '(a*)', fields: { 1: b } }
+  - name: "either"
+    branched:
+      branching-script: ''
+      debranching-script: ''
+      rules:
+        - existing: { tag: "greedy" }
+        - linear: { pattern: '(a+)', fields: { 1: a } }
+  - name: "sum"
+    branched:
+      branching-script: ''
+      debranching-script: ''
+      rules:
+        - existing: { tag: "sum-pair" }
+        - linear: { pattern: '\d', fields: { 0: value } }
+  - name: "sum-pair"
+    continual:
+      - existing: { tag: "sum", prefix: "left" }
+      - linear: { pattern: '\+(\d)', fields: { 1: right } }
+  - name: "words"
+    recurrent-dict:
+      key: 'value'
+      tag: "word"
+  - name: "word"
+    continual:
+      - linear: { pattern: '(\w+) ?', fields: { 1: word } }
+  - name: "spaced"
+    continual:
+      - linear: { pattern: '((?:\w+ )*)', fields: { 1: words } }
+  - name: "word-list"
+    recurrent:
+      - linear: { pattern: '(\w+)', fields: { 1: word } }
+      - infix: { pattern: ', ' }
+  - name: "any-list"
+    recurrent:
+      - linear: { pattern: '(.+)', fields: { 1: value } }
+      - infix: { pattern: ', ' }
+  - name: "lists"
+    recurrent:
+      - linear: { pattern: '\[' }
+      - existing: { tag: "word-list" }
+      - linear: { pattern: '\]' }
+      - infix: { pattern: ', ' }
+  - name: "flat-lists"
+    recurrent:
+      - existing: { tag: "word-list" }
+      - infix: { pattern: '; ' }
+  - name: "joined-lists"
+    recurrent:
+      - existing: { tag: "word-list" }
+      - infix: { pattern: ', ' }
+)");
+    REQUIRE(config);
+    const Program program{ *config };
+
+    const auto run = [&](std::string_view sv, std::string_view tag) {
+        return program.run(sv, tag, &no_dyn_patterns, &pass_fields);
+    };
+
+    SECTION("recurrent with infix")
+    {
+        const auto result = run("[ ( 1, 2 ), ( -3, 4 ) ]", "pos-list");
+        REQUIRE(result);
+        REQUIRE(result->contains("x"));
+        auto const& xs = result->at("x").as_const_list();
+        auto const& ys = result->at("y").as_const_list();
+        REQUIRE(xs.size() == 2);
+        REQUIRE(ys.size() == 2);
+        CHECK(xs[0].as_const_string() == "1");
+        CHECK(xs[1].as_const_string() == "-3");
+        CHECK(ys[1].as_const_string() == "4");
+
+        const auto empty = run("[  ]", "pos-list");
+        REQUIRE(empty);
+        CHECK(empty->empty());
+
+        // infix must be followed by element
+        CHECK_FALSE(run("[ ( 1, 2 ),  ]", "pos-list"));
+    }
+
+    SECTION("separable elements")
+    {
+        CHECK(program.is_separable("pos-list-payload"));
+        CHECK(program.is_separable("word-list"));
+        CHECK(program.is_separable("lists"));
+        CHECK(program.is_separable("flat-lists"));
+        // element may contain separator
+        CHECK_FALSE(program.is_separable("any-list"));
+        CHECK_FALSE(program.is_separable("joined-lists"));
+        // no separator
+        CHECK_FALSE(program.is_separable("words"));
+    }
+
+    SECTION("prefix")
+    {
+        const auto result = run("1, 2 -> 3, 4", "input");
+        REQUIRE(result);
+        CHECK(result->at("from@x").as_const_string() == "1");
+        CHECK(result->at("to@y").as_const_string() == "4");
+    }
+
+    SECTION("backtrack")
+    {
+        // 'a+' gives back one character to 'ab'
+        const auto greedy = run("aaab", "greedy");
+        REQUIRE(greedy);
+        CHECK(greedy->at("a").as_const_string() == "aa");
+
+        // first branch fails, second one is matched
+        const auto either = run("aaa", "either");
+        REQUIRE(either);
+        CHECK(either->at("branch").as_const_i64() == 1);
+        CHECK(either->at("a").as_const_string() == "aaa");
+    }
+
+    SECTION("left recursion")
+    {
+        const auto result = run("1+2+3", "sum");
+        REQUIRE(result);
+        CHECK(result->at("right").as_const_string() == "3");
+        CHECK(result->at("left@right").as_const_string() == "2");
+        CHECK(result->at("left@left@value").as_const_string() == "1");
+    }
+
+    SECTION("recurrent-dict")
+    {
+        const auto result = run("ab cd", "words");
+        REQUIRE(result);
+        auto const& words = result->at("value").as_const_list();
+        REQUIRE(words.size() == 2);
+        CHECK(words[1].as_const_map().at("word").as_const_string() == "cd");
+
+        const auto empty = run("", "words");
+        REQUIRE(empty);
+        CHECK(empty->at("value").as_const_list().empty());
+    }
+
+    SECTION("script rejects match")
+    {
+        // longer first half is rejected, so 'a+' must give back characters to 'a*'
+        const auto result = program.run("aaaa", "halves", &no_dyn_patterns, [](auto const& call) {
+            return call.fields.size() == 2 && call.fields[0].value.size() <= call.fields[1].value.size()
+                       ? pass_fields(call)
+                       : dynser::deserialize::ScriptResult{ std::unexpected{ "unbalanced" } };
+        });
+        REQUIRE(result);
+        CHECK(result->at("a").as_const_string() == "aa");
+        CHECK(result->at("b").as_const_string() == "aa");
+    }
+
+    SECTION("long input")
+    {
+        std::string input;
+        for (std::size_t ind{}; ind < 100'000; ++ind) {
+            input += "ab ";
+        }
+        const auto result = run(input, "spaced");
+        REQUIRE(result);
+        CHECK(result->at("words").as_const_string().size() == input.size());
+    }
+
+    SECTION("no match")
+    {
+        const auto result = run("[ ( 1, 2 ), ( 3; 4 ) ]", "pos-list");
+        REQUIRE_FALSE(result);
+        // furthest failed rule is pattern of second pos
+        CHECK(result.error().position == 14);
+        CHECK_FALSE(result.error().script_error);
+    }
+}
+
+TEST_CASE("Deserialize program memo")
+{
+    using dynser::deserialize::MemoEviction;
+    using dynser::deserialize::MemoOptions;
+    using dynser::deserialize::Program;
+
+    // both branches call 'item' at the same position, so without memo nested items are matched 2^depth times
+    const auto config = dynser::config::from_string(R"(
+version: ''
+tags:
+  - name: "either"
+    branched:
+      branching-script: ''
+      debranching-script: ''
+      rules:
+        - existing: { tag: "with-a" }
+        - existing: { tag: "with-b" }
+  - name: "with-a"
+    continual:
+      - existing: { tag: "item" }
+      - linear: { pattern: 'A' }
+  - name: "with-b"
+    continual:
+      - existing: { tag: "item" }
+      - linear: { pattern: 'B' }
+  - name: "item"
+    branched:
+      branching-script: ''
+      debranching-script: ''
+      rules:
+        - existing: { tag: "nested" }
+        - linear: { pattern: '(\w)', fields: { 1: x } }
+  - name: "nested"
+    continual:
+      - linear: { pattern: '\(' }
+      - existing: { tag: "either", prefix: "in" }
+      - linear: { pattern: '\)' }
+)");
+    REQUIRE(config);
+
+    const auto nested = [](std::size_t depth) {
+        std::string result = "xB";
+        for (std::size_t ind{}; ind < depth; ++ind) {
+            result = '(' + result + (ind % 3 == 0 ? ")A" : ")B");
+        }
+        return result;
+    };
+    const auto run = [&](Program const& program, std::string_view sv) {
+        return program.run(sv, "either", &no_dyn_patterns, &pass_fields);
+    };
+
+    const Program no_memo{ *config, MemoOptions{ .max_bytes = 0 } };
+    const Program lru{ *config };
+    const Program small_lru{ *config, MemoOptions{ .max_bytes = 4096 } };
+    const Program drop_new{ *config, MemoOptions{ .max_bytes = 4096, .eviction = MemoEviction::DropNew } };
+
+    SECTION("same result")
+    {
+        for (std::size_t depth{}; depth < 8; ++depth) {
+            const auto sv = nested(depth);
+            const auto expected = run(no_memo, sv);
+            REQUIRE(expected);
+            CHECK(dump(run(lru, sv)) == dump(expected));
+            CHECK(dump(run(small_lru, sv)) == dump(expected));
+            CHECK(dump(run(drop_new, sv)) == dump(expected));
+        }
+
+        const auto failed = run(no_memo, "((xB)C)B");
+        REQUIRE_FALSE(failed);
+        CHECK(dump(run(lru, "((xB)C)B")) == dump(failed));
+    }
+
+    SECTION("repeated calls are replayed")
+    {
+        // would take 2^40 matches of 'x' without memo
+        const auto result = run(lru, nested(40));
+        REQUIRE(result);
+        CHECK(result->contains("branch"));
+    }
+}
@@ -0,0 +1,25 @@
+#include "deserialize/split.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include <string_view>
+#include <vector>
+
+TEST_CASE("Deserialize split")
+{
+    using dynser::deserialize::split_elements;
+    using Parts = std::vector<std::string_view>;
+
+    CHECK(split_elements("1, 2, 3", ", ") == Parts{ "1", "2", "3" });
+    CHECK(split_elements("", ", ") == Parts{ "" });
+
+    // separators inside brackets and escaped ones are skipped
+    CHECK(split_elements("( 1, 2 ), [ {3, 4} ], 5", ", ") == Parts{ "( 1, 2 )", "[ {3, 4} ]", "5" });
+    CHECK(split_elements(R"(a\, b, c\\, d)", ", ") == Parts{ R"(a\, b)", R"(c\\)", "d" });
+
+    // ambiguous
+    CHECK_FALSE(split_elements("( 1, 2", ", "));
+    CHECK_FALSE(split_elements("( 1, 2 ]", ", "));
+    CHECK_FALSE(split_elements("1 ), 2", ", "));
+    CHECK_FALSE(split_elements("1), (2", "), ("));
+    CHECK_FALSE(split_elements("1, 2", ""));
+}
@@ -0,0 +1,138 @@
+#include "config/config.h"
+#include "deserialize/stream.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+TEST_CASE("Deserialize stream")
+{
+    using dynser::Properties;
+    using dynser::deserialize::Program;
+    using dynser::deserialize::Stream;
+
+    const auto config = dynser::config::from_string(R"(
+version: ''
+tags:
+  - name: "pos-list-payload"
+    recurrent:
+      - linear: { pattern: '\( ' }
+      - existing: { tag: "pos" }
+      - linear: { pattern: ' \)' }
+      - infix: { pattern: ', ' }
+  - name: "pos"
+    continual:
+      - linear: { pattern: '(-?\d+), (-?\d+)', fields: { 1: x, 2: y } }
+  - name: "words"
+    recurrent:
+      - linear: { pattern: '(\w) ?', fields: { 1: word } }
+  - name: "numbers"
+    recurrent:
+      - linear: { pattern: '(\d+)', fields: { 1: number } }
+      - infix: { pattern: ', *' }
+)");
+    REQUIRE(config);
+    const Program program{ *config };
+
+    const auto pass_fields = [](dynser::deserialize::ScriptCall const& call) -> dynser::deserialize::ScriptResult {
+        Properties result;
+        for (auto const& [name, value] : call.fields) {
+            result.insert_or_assign(std::string{ name }, dynser::PropertyValue{ std::string{ value } });
+        }
+        return result;
+    };
+    const auto no_dyn_patterns = [](Program::Linear const&) -> dynser::regex::Matcher const* { return nullptr; };
+
+    std::vector<Properties> elements;
+    const auto stream_of = [&](std::string_view tag) {
+        return Stream{ program, tag, [&elements](Properties&& props) { elements.push_back(std::move(props)); } };
+    };
+    const auto feed_by = [&](Stream& stream, std::string_view input, std::size_t chunk_size) {
+        for (std::size_t pos{}; pos < input.size(); pos += chunk_size) {
+            stream.feed(input.substr(pos, chunk_size), no_dyn_patterns, pass_fields);
+        }
+    };
+
+    SECTION("elements are passed as soon as matched")
+    {
+        auto stream = stream_of("pos-list-payload");
+        feed_by(stream, "( 1, 2 ), ( -3, 4 ), ", 3);
+        REQUIRE(elements.size() == 2);
+        CHECK(elements[1].at("x").as_const_string() == "-3");
+        CHECK(stream.buffered().empty());
+
+        feed_by(stream, "( 5, 6 )", 3);
+        CHECK(elements.size() == 2);
+        REQUIRE(stream.finish(no_dyn_patterns, pass_fields));
+        REQUIRE(elements.size() == 3);
+        CHECK(elements[2].at("y").as_const_string() == "6");
+        CHECK(stream.consumed() == 29);
+    }
+
+    SECTION("empty input")
+    {
+        auto stream = stream_of("pos-list-payload");
+        REQUIRE(stream.finish(no_dyn_patterns, pass_fields));
+        CHECK(elements.empty());
+    }
+
+    SECTION("infix must be followed by element")
+    {
+        auto stream = stream_of("pos-list-payload");
+        feed_by(stream, "( 1, 2 ), ", 4);
+        CHECK(elements.size() == 1);
+        const auto result = stream.finish(no_dyn_patterns, pass_fields);
+        REQUIRE_FALSE(result);
+        CHECK(result.error().position == 10);
+    }
+
+    SECTION("element is passed when infix can't be continued by next chunks")
+    {
+        for (const std::string_view input : { "12, 3", "1,   2" }) {
+            for (std::size_t chunk_size{ 1 }; chunk_size <= input.size(); ++chunk_size) {
+                INFO("input '" << input << "' by " << chunk_size);
+                elements.clear();
+                auto stream = stream_of("numbers");
+                feed_by(stream, input, chunk_size);
+                REQUIRE(stream.finish(no_dyn_patterns, pass_fields));
+                REQUIRE(elements.size() == 2);
+                CHECK(elements[0].at("number").as_const_string() == input.substr(0, input.find(',')));
+                CHECK(elements[1].at("number").as_const_string() == input.substr(input.size() - 1));
+            }
+        }
+    }
+
+    SECTION("invalid input is reported by feed")
+    {
+        auto stream = stream_of("pos-list-payload");
+        REQUIRE(stream.feed("( 1, 2 ), ( 3", no_dyn_patterns, pass_fields));
+        const auto result = stream.feed(", x ), ( 5, 6 )", no_dyn_patterns, pass_fields);
+        REQUIRE_FALSE(result);
+        CHECK(result.error().position == 12);
+        CHECK(elements.size() == 1);
+        // next chunks are ignored
+        CHECK_FALSE(stream.feed("( 7, 8 )", no_dyn_patterns, pass_fields));
+        const auto finished = stream.finish(no_dyn_patterns, pass_fields);
+        REQUIRE_FALSE(finished);
+        CHECK(finished.error().position == 12);
+    }
+
+    SECTION("recurrent tag without infix is matched on finish")
+    {
+        auto stream = stream_of("words");
+        feed_by(stream, "a b c", 2);
+        CHECK(elements.empty());
+        REQUIRE(stream.finish(no_dyn_patterns, pass_fields));
+        REQUIRE(elements.size() == 3);
+        CHECK(elements[2].at("word").as_const_string() == "c");
+    }
+
+    SECTION("not recurrent tag is one element")
+    {
+        auto stream = stream_of("pos");
+        feed_by(stream, "7, 8", 1);
+        REQUIRE(stream.finish(no_dyn_patterns, pass_fields));
+        REQUIRE(elements.size() == 1);
+        CHECK(elements[0].at("x").as_const_string() == "7");
+    }
+}
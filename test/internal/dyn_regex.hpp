@@ -25,3 +25,24 @@ TEST_CASE("Dyn regex")
     CHECK(!std::regex_match("pos:[04,12]", std::regex{ with_prefix }));
     CHECK(!std::regex_match("pos: [4,12]", std::regex{ with_prefix }));
 }
+
+TEST_CASE("Dyn regex split")
+{
+    using namespace dynser::config;
+
+    const auto dyn_regex = details::split_dyn_regex(R"(\_2\[\d{\_1},\d{\_10}\]\\_)");
+
+    const std::vector<std::string> expected_segments{ "", R"(\[\d{)", R"(},\d{)", R"(}\]\\_)" };
+    const std::vector<std::size_t> expected_slots{ 2, 1, 10 };
+
+    CHECK(dyn_regex.segments == expected_segments);
+    CHECK(dyn_regex.slots == expected_slots);
+
+    const yaml::DynGroupValues dyn_group_values{ { 1, "4" }, { 10, "2" } };
+    CHECK(details::resolve_dyn_regex(dyn_regex, dyn_group_values) == R"(\[\d{4},\d{2}\]\\_)");
+
+    // non-ASCII (UTF-8) bytes are not digits
+    const auto utf8 = details::split_dyn_regex("\\_1\xD9\xA1\\_\xD9\xA1");
+    CHECK(utf8.slots == std::vector<std::size_t>{ 1 });
+    CHECK(utf8.segments == std::vector<std::string>{ "", "\xD9\xA1\\_\xD9\xA1" });
+}
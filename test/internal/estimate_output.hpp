@@ -0,0 +1,74 @@
+#include "dynser.h"
+#include <catch2/catch_test_macros.hpp>
+#include <unordered_set>
+
+#include <cstdint>
+#include <string>
+
+TEST_CASE("Estimate output size")
+{
+    using dynser::PropertyValue;
+
+    const auto config = dynser::config::from_string(R"(
+version: ''
+tags:
+  - name: "pos"
+    continual:
+      - linear: { pattern: '(-?\d+), (-?\d+)', fields: { 1: x, 2: y } }
+  - name: "pos-list"
+    recurrent:
+      - linear: { pattern: '\( ' }
+      - existing: { tag: "pos" }
+      - linear: { pattern: ' \)' }
+      - infix: { pattern: ', ' }
+  - name: "input"
+    continual:
+      - existing: { tag: "pos", prefix: "from" }
+      - linear: { pattern: ' -> ' }
+      - existing: { tag: "pos-list", prefix: "to" }
+)");
+    REQUIRE(config);
+
+    const auto estimate = [&](dynser::Properties const& props, std::string const& tag) {
+        std::unordered_set<std::string> visiting;
+        return dynser::details::estimate_output_size(*config, dynser::PropertiesView{ props }, tag, visiting);
+    };
+
+    SECTION("group values")
+    {
+        const dynser::Properties props{ { "x", PropertyValue{ "12345" } }, { "y", PropertyValue{ "-678" } } };
+        // "12345, -678"
+        CHECK(estimate(props, "pos") == 11);
+    }
+
+    SECTION("integer values")
+    {
+        const dynser::Properties props{
+            { "x", PropertyValue{ std::uint64_t{ 18446744073709551615u } } },
+            { "y", PropertyValue{ std::int32_t{ -5 } } },
+        };
+        // "18446744073709551615, -5"
+        CHECK(estimate(props, "pos") == 24);
+    }
+
+    SECTION("prefixed recurrent")
+    {
+        PropertyValue::ListType<PropertyValue> xs;
+        PropertyValue::ListType<PropertyValue> ys;
+        for (std::size_t ind{}; ind < 1000; ++ind) {
+            xs.emplace_back("123");
+            ys.emplace_back(std::int64_t{ -45 });
+        }
+        const dynser::Properties props{
+            { "from@x", PropertyValue{ "1" } },
+            { "from@y", PropertyValue{ "2" } },
+            { "to@x", PropertyValue{ std::move(xs) } },
+            { "to@y", PropertyValue{ std::move(ys) } },
+        };
+        // "1, 2 -> " and 1000 of "( 123, -45 ), "
+        const std::size_t expected = 8 + 1000 * 14;
+        const auto result = estimate(props, "input");
+        CHECK(result >= expected * 9 / 10);
+        CHECK(result <= expected * 11 / 10);
+    }
+}
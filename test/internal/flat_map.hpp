@@ -0,0 +1,37 @@
+#include "util/flat_map.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+TEST_CASE("Flat map")
+{
+    using Map = dynser::util::FlatMap<std::string, int>;
+
+    Map map{ { "b", 2 }, { "a", 1 }, { "b", 3 } };
+
+    // first of repeated keys is kept, like in std::map
+    REQUIRE(map.size() == 2);
+    CHECK(map.begin()->first == "a");
+    CHECK(map.at("b") == 2);
+
+    map["c"] = 4;
+    const auto [it, is_inserted] = map.insert({ "a", 5 });
+    CHECK(!is_inserted);
+    CHECK(it->second == 1);
+    CHECK(map.contains(std::string_view{ "c" }));
+    CHECK(!map.contains("d"));
+
+    Map other{ { "a", 10 }, { "d", 11 } };
+    map.merge(other);
+    CHECK(map.size() == 4);
+    CHECK(map.at("a") == 1);
+    CHECK(map.at("d") == 11);
+    // entry with existing key is left in source
+    REQUIRE(other.size() == 1);
+    CHECK(other.at("a") == 10);
+
+    CHECK(map.erase("b") == 1);
+    CHECK(map.erase("b") == 0);
+    const Map expected{ { "a", 1 }, { "c", 4 }, { "d", 11 } };
+    CHECK(map == expected);
+}
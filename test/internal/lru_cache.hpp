@@ -0,0 +1,42 @@
+#include "util/lru_cache.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+TEST_CASE("LRU cache")
+{
+    using dynser::util::LruCache;
+
+    LruCache<std::string, int> cache{ 2 };
+
+    cache.insert("a", 1);
+    cache.insert("b", 2);
+    REQUIRE(cache.find("a"));
+    CHECK(*cache.find("a") == 1);
+
+    // 'b' is least recently used
+    cache.insert("c", 3);
+    CHECK(cache.size() == 2);
+    CHECK(!cache.find("b"));
+    CHECK(cache.find("a"));
+    CHECK(cache.find("c"));
+
+    // replace keeps size
+    cache.insert("c", 4);
+    CHECK(cache.size() == 2);
+    CHECK(*cache.find("c") == 4);
+
+    auto copy = cache;
+    copy.insert("d", 5);
+    CHECK(copy.find("d"));
+    CHECK(!cache.find("d"));
+    CHECK(*copy.find("c") == 4);
+
+    // replaced and evicted values are reported
+    std::vector<int> dropped;
+    const auto on_drop = [&](std::string const&, const int value) { dropped.push_back(value); };
+    cache.insert("c", 6, on_drop);
+    cache.insert("e", 7, on_drop);
+    CHECK(dropped == std::vector<int>{ 4, 1 });
+}
@@ -0,0 +1,38 @@
+#include "lua/state_pool.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <string>
+
+TEST_CASE("Lua state pool")
+{
+    using dynser::lua::StatePool;
+
+    StatePool pool;
+
+    const auto script = dynser::lua::compile("counter = (counter or 0) + 1; result = counter", "test");
+    REQUIRE(script);
+
+    SECTION("globals are cleared on release")
+    {
+        for (int run{}; run < 2; ++run) {
+            auto handle = pool.acquire();
+            REQUIRE(handle.run(*script) == LUA_OK);
+            REQUIRE(handle.run(*script) == LUA_OK);
+            // handle keeps globals between its runs
+            CHECK((*handle)["result"].read<std::int64_t>() == 2);
+        }
+        CHECK(pool.size() == 1);
+    }
+
+    SECTION("standard library is kept")
+    {
+        const auto uses_library = dynser::lua::compile("result = string.format('%d', math.max(1, 2))", "test");
+        REQUIRE(uses_library);
+        for (int run{}; run < 2; ++run) {
+            auto handle = pool.acquire();
+            REQUIRE(handle.run(*uses_library) == LUA_OK);
+            CHECK((*handle)["result"].read<std::string>() == "2");
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#include "dynser.h"
+#include "util/layered_map.hpp"
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Properties view")
+{
+    using namespace dynser;
+
+    const auto props = util::map_to_props(
+        "a", 1, "tag@a", 2, "tag@b", 3, "next@a", 4, "next@tag@c", 5, "next@next@a", 6, "nextx@d", 7
+    );
+    const PropertiesView view{ props };
+
+    REQUIRE(view.size() == props.size());
+    CHECK(view.at("tag@b").as_const_i32() == 3);
+    CHECK(!view.contains("b"));
+
+    SECTION("without prefix")
+    {
+        const auto scoped = view.scoped(std::nullopt, "tag");
+        // 'tag@' properties replace parent ones
+        CHECK(scoped.at("a").as_const_i32() == 2);
+        CHECK(scoped.at("b").as_const_i32() == 3);
+        CHECK(scoped.at("next@a").as_const_i32() == 4);
+        CHECK(scoped.size() == props.size() + 1);
+    }
+
+    SECTION("with prefix")
+    {
+        const auto scoped = view.scoped("next", "tag");
+        CHECK(scoped.at("a").as_const_i32() == 4);
+        CHECK(scoped.at("c").as_const_i32() == 5);
+        CHECK(scoped.at("tag@c").as_const_i32() == 5);
+        CHECK(scoped.at("next@a").as_const_i32() == 6);
+
+        // nested scope
+        const auto nested = scoped.scoped("next", "tag");
+        REQUIRE(nested.size() == 1);
+        CHECK(nested.at("a").as_const_i32() == 6);
+    }
+}
+
+TEST_CASE("Properties view of list elements")
+{
+    using namespace dynser;
+    using List = PropertyValue::ListType<PropertyValue>;
+
+    const auto props =
+        util::map_to_props("a", 0, "b", List{ PropertyValue{ 1 }, PropertyValue{ 2 } }, "c", List{ PropertyValue{ 3 } });
+    const PropertiesView view{ props };
+
+    const auto non_lists = view.non_lists();
+    REQUIRE(non_lists.size() == 1);
+    CHECK(non_lists.at("a").as_const_i32() == 0);
+
+    const auto first = view.list_elements(0);
+    REQUIRE(first.size() == 2);
+    CHECK(first.at("b").as_const_i32() == 1);
+    CHECK(first.at("c").as_const_i32() == 3);
+    // points into list
+    CHECK(&first.at("b") == &props.at("b").as_const_list()[0]);
+
+    const auto second = view.list_elements(1);
+    REQUIRE(second.size() == 1);
+    CHECK(second.at("b").as_const_i32() == 2);
+
+    CHECK(view.list_elements(2).empty());
+
+    // refilled from list properties only
+    const auto lists = view.lists();
+    REQUIRE(lists.size() == 2);
+    CHECK_FALSE(lists.contains("a"));
+    PropertiesView element;
+    lists.list_elements(0, element);
+    REQUIRE(element.size() == 2);
+    CHECK(&element.at("c") == &props.at("c").as_const_list()[0]);
+    lists.list_elements(1, element);
+    REQUIRE(element.size() == 1);
+    CHECK(element.at("b").as_const_i32() == 2);
+    lists.list_elements(2, element);
+    CHECK(element.empty());
+}
+
+TEST_CASE("Overlaid properties view")
+{
+    using namespace dynser;
+
+    const auto base_props = util::map_to_props("a", 1, "b", 2, "tag@c", 3);
+    const PropertiesView base{ base_props };
+    const auto element_props = util::map_to_props("b", 20, "d", 40);
+    const PropertiesView element{ element_props };
+    const OverlaidPropertiesView view{ base, element };
+
+    // element properties replace base ones
+    CHECK(view.at("a").as_const_i32() == 1);
+    CHECK(view.at("b").as_const_i32() == 20);
+    CHECK(view.at("d").as_const_i32() == 40);
+    CHECK(!view.contains("c"));
+    CHECK(view.merged().size() == 4);
+    CHECK(view.to_properties().at("b").as_const_i32() == 20);
+
+    const auto scoped = view.scoped(std::nullopt, "tag");
+    CHECK(scoped.at("c").as_const_i32() == 3);
+    CHECK(scoped.at("b").as_const_i32() == 20);
+
+    const Fields front{ { "x", "1" } };
+    const Fields back{ { "x", "2" }, { "y", "3" } };
+    const util::LayeredMap<Fields> fields{ front, back };
+    CHECK(fields.at("x") == "1");
+    CHECK(fields.at("y") == "3");
+    CHECK(!fields.contains("z"));
+}
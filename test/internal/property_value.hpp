@@ -0,0 +1,63 @@
+#include "structs/properties.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+TEST_CASE("Property value integers")
+{
+    using dynser::PropertyValue;
+
+    SECTION("conversion")
+    {
+        // lua integers are read as i64, scripts and mappers ask for the type they expect
+        const PropertyValue read_from_lua{ std::int64_t{ 42 } };
+        CHECK(read_from_lua.to_u64() == 42u);
+        CHECK(read_from_lua.to_i32() == 42);
+        CHECK(read_from_lua.is_i64());
+        CHECK(read_from_lua.as_const_i64() == 42);
+    }
+
+    SECTION("out of range")
+    {
+        CHECK_FALSE(PropertyValue{ std::int64_t{ -1 } }.to_u32());
+        CHECK_FALSE(PropertyValue{ std::int64_t{ -1 } }.to_u64());
+        CHECK_FALSE(PropertyValue{ std::numeric_limits<std::uint64_t>::max() }.to_i64());
+        CHECK_FALSE(PropertyValue{ std::int64_t{ std::numeric_limits<std::int32_t>::max() } + 1 }.to_i32());
+        CHECK_FALSE(PropertyValue{ "42" }.to_i64());
+        CHECK_FALSE(PropertyValue{ 42.0 }.to_i64());
+    }
+
+    SECTION("lua accessors")
+    {
+        luwra::StateWrapper state;
+        state.loadStandardLibrary();
+        dynser::register_userdata_property_value(state);
+
+        state["value"] = PropertyValue{ std::int64_t{ 7 } };
+        REQUIRE(state.runString("result = value:as_u32() + 1") == LUA_OK);
+        CHECK(state["result"].read<std::int64_t>() == 8);
+
+        state["value"] = PropertyValue{ std::int64_t{ -1 } };
+        CHECK(state.runString("result = value:as_u32()") != LUA_OK);
+    }
+}
+
+TEST_CASE("Property value views")
+{
+    using dynser::PropertyValue;
+
+    const std::string input{ "abc" };
+    PropertyValue viewed{ std::string_view{ input } };
+    const PropertyValue list{ PropertyValue::ListType<PropertyValue>{ viewed } };
+    CHECK(viewed.has_views());
+    CHECK(list.has_views());
+    CHECK_FALSE(PropertyValue{ "abc" }.has_views());
+
+    // mutable string accessor materializes view
+    CHECK(viewed.as_string() == "abc");
+    CHECK(viewed.is_string());
+    CHECK(viewed.as_const_string().data() != input.data());
+}
@@ -0,0 +1,127 @@
+#include "dynser.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include <regex>
+
+TEST_CASE("Regex match")
+{
+    using namespace dynser::regex;
+
+    // results must be same as std::regex_match gives
+    const std::pair<std::string_view, std::vector<std::string_view>> tests[]{
+        { "abc", { "abc", "ab", "abcd", "" } },
+        { "a.c", { "abc", "a\nc", "ac", "a.c" } },
+        { "\\d+", { "0", "0123", "", "12a" } },
+        { "[a-f\\d]{2,4}", { "a", "af", "a0f9", "a0f9e", "ag" } },
+        { "[^\\s,]*", { "", "word", "two words", "a,b", "tab\t" } },
+        { "\\w*?x", { "x", "abcx", "abcxx", "abc" } },
+        { "(ab)+", { "ab", "abab", "aba", "" } },
+        { "(?:ab|cd)e", { "abe", "cde", "abde", "ae" } },
+        { "yes|no", { "yes", "no", "yeso", "yno" } },
+        { "a|b|c", { "a", "b", "c", "ab", "" } },
+        { "(\\w)\\1", { "aa", "ab", "a" } },
+        { "(a*)*b", { "b", "aab", "aaaa" } },
+        { "(?=\\d)\\w+", { "1a", "a1", "" } },
+        { "(?!ab)\\w{2}", { "ab", "ba", "aa" } },
+        { "x{0,2}?y", { "y", "xy", "xxy", "xxxy" } },
+        { "[\\]\\-]+", { "]-]", "-", "a" } },
+        // counted loops
+        { "(ab){9,10}", { "abababababababababab", "ababababababababab", "abababababababababababab", "" } },
+        { "(?:a|bc){2,12}?c", { "aac", "abcbcc", "ac", "aaaaaaaaaaaaac" } },
+        { "(a?){10}", { "", "aaa", "aaaaaaaaaaa" } },
+        { "(x*){10,}y", { "y", "xxy", "xxyy" } },
+        { "(\\w)\\1{9}", { "aaaaaaaaaa", "aaaaaaaaa", "aaaaaaaaab" } },
+    };
+
+    for (std::size_t num{}; const auto& [pattern, values] : tests) {
+        DYNAMIC_SECTION("Regex# " << num << " '" << pattern << "'")
+        {
+            const auto reg = from_string(pattern);
+            REQUIRE(reg);
+            const Matcher matcher{ *reg };
+            const std::regex expected{ pattern.data(), pattern.size() };
+
+            for (const auto value : values) {
+                INFO("value '" << value << "'");
+                CHECK(matcher.match(value) == std::regex_match(value.begin(), value.end(), expected));
+            }
+        }
+        ++num;
+    }
+}
+
+TEST_CASE("Regex match group")
+{
+    using namespace dynser::regex;
+
+    // values of nested groups are matched by sub-programs of one program
+    const auto reg = from_string("a(\\d+(x|y){2})b(\\2)");
+    REQUIRE(reg);
+    const Matcher matcher{ *reg };
+
+    CHECK(matcher.match_group("12xy", 1));
+    CHECK(!matcher.match_group("12x", 1));
+    CHECK(!matcher.match_group("a12xy", 1));
+    CHECK(matcher.match_group("y", 2));
+    CHECK(!matcher.match_group("xy", 2));
+    // backreference to group outside of value matches empty string
+    CHECK(matcher.match_group("", 3));
+    CHECK(!matcher.match_group("", 4));
+}
+
+TEST_CASE("Regex match lookbehind")
+{
+    using namespace dynser::regex;
+
+    // not supported by std::regex
+    const auto reg = from_string("\\w+(?<=a)b");
+    REQUIRE(reg);
+    const Matcher matcher{ *reg };
+
+    CHECK(matcher.match("aab"));
+    CHECK(!matcher.match("acb"));
+    CHECK(matcher.match_prefix("aab!") == 3);
+}
+
+TEST_CASE("Regex match long input")
+{
+    using namespace dynser::regex;
+
+    // every loop iteration is a backtrack point, call stack must not grow with them
+    const auto reg = from_string("((?:\\w+ )*)");
+    REQUIRE(reg);
+    const Matcher matcher{ *reg };
+
+    std::string input;
+    for (std::size_t ind{}; ind < 100'000; ++ind) {
+        input += "ab ";
+    }
+    CHECK(matcher.match(input));
+    CHECK(matcher.match_prefix(input + "ab") == input.size());
+    CHECK(!matcher.match(input + "ab"));
+}
+
+TEST_CASE("Regex match hit end")
+{
+    using namespace dynser::regex;
+
+    const auto hit_end_of = [](const std::string_view pattern, const std::string_view value) {
+        const auto reg = from_string(pattern);
+        REQUIRE(reg);
+        const Matcher matcher{ *reg };
+        bool hit_end{};
+        matcher.match_prefixes(value, [](Matcher::PrefixMatch const&) { return true; }, hit_end);
+        return hit_end;
+    };
+
+    // greedy run may take more characters
+    CHECK(hit_end_of(", *", ",  "));
+    CHECK(!hit_end_of(", *", ",  x"));
+    // lazy run is done before the end
+    CHECK(!hit_end_of(", *?", ",  "));
+    CHECK(hit_end_of("ab", "a"));
+    CHECK(!hit_end_of("ab", "x"));
+    CHECK(hit_end_of("(a)x\\1", "ax"));
+    CHECK(!hit_end_of("(a)x\\1", "axb"));
+    CHECK(!hit_end_of("a{2}", "aa"));
+}
@@ -0,0 +1,67 @@
+#include "regex/scan.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+TEST_CASE("Regex scan")
+{
+    using dynser::regex::SetScanner;
+    using CharSet = SetScanner::CharSet;
+
+    const auto set_of = [](auto&& predicate) {
+        CharSet result;
+        for (std::size_t c{}; c < result.size(); ++c) {
+            result[c] = predicate(static_cast<unsigned char>(c));
+        }
+        return result;
+    };
+
+    const std::pair<std::string_view, CharSet> sets[]{
+        { "digits", set_of([](unsigned char c) { return c >= '0' && c <= '9'; }) },
+        { "word", set_of([](unsigned char c) {
+              return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+          }) },
+        { "wildcard", set_of([](unsigned char c) { return c != '\n' && c != '\r'; }) },
+        { "single", set_of([](unsigned char c) { return c == ','; }) },
+        { "not vectorized", set_of([](unsigned char c) { return c % 4 == 0; }) },
+        { "empty", CharSet{} },
+        { "high", set_of([](unsigned char c) { return c >= 0x80; }) },
+    };
+
+    // every byte value at every offset around block boundaries
+    std::string subject;
+    for (std::size_t ind{}; ind < 1024; ++ind) {
+        subject += static_cast<char>((ind * 37 + ind / 256) % 256);
+    }
+
+    for (auto const& [name, set] : sets) {
+        DYNAMIC_SECTION("Set " << name)
+        {
+            const SetScanner scanner{ set };
+            CHECK(scanner.is_vectorized() == (name != "not vectorized"));
+
+            // results must be same as byte by byte lookup gives
+            for (std::size_t begin{}; begin < 40; ++begin) {
+                for (auto const fill : { 'a', '7', '\n', ',', '\x80' }) {
+                    for (std::size_t length : { 0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100 }) {
+                        auto value = std::string(length, fill) + subject.substr(begin, 64);
+                        std::size_t expected_span{};
+                        while (expected_span < value.size() && set[static_cast<unsigned char>(value[expected_span])]) {
+                            ++expected_span;
+                        }
+                        std::size_t expected_find{};
+                        while (expected_find < value.size() && !set[static_cast<unsigned char>(value[expected_find])]) {
+                            ++expected_find;
+                        }
+                        INFO("begin " << begin << ", length " << length << ", fill " << int(fill));
+                        CHECK(scanner.span(value) == expected_span);
+                        CHECK(scanner.find(value) == expected_find);
+                    }
+                }
+            }
+        }
+    }
+
+    CHECK(SetScanner{ sets[3].second }.single() == ',');
+    CHECK_FALSE(SetScanner{ sets[0].second }.single());
+}
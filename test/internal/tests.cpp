@@ -1,7 +1,19 @@
 // make one target with all tests
 
+#include "deserialize_program.hpp"
+#include "deserialize_split.hpp"
+#include "deserialize_stream.hpp"
 #include "dyn_regex.hpp"
+#include "estimate_output.hpp"
+#include "flat_map.hpp"
+#include "lru_cache.hpp"
+#include "lua_state_pool.hpp"
+#include "properties_view.hpp"
+#include "property_value.hpp"
+#include "regex_match.hpp"
 #include "regex_parse.hpp"
+#include "regex_scan.hpp"
 #include "regex_to_string.hpp"
+#include "thread_pool.hpp"
 
 // main() will be generated by catch2 (linking with Catch2::Catch2WithMain)
@@ -0,0 +1,50 @@
+#include "parallel/thread_pool.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <vector>
+
+TEST_CASE("Thread pool")
+{
+    using dynser::parallel::ThreadPool;
+
+    ThreadPool pool{ 4 };
+    REQUIRE(pool.size() == 4);
+
+    SECTION("each index once")
+    {
+        constexpr std::size_t count = 10'000;
+        std::vector<std::atomic<int>> visits(count);
+        pool.for_each_chunk(count, 16, [&](std::size_t begin, std::size_t end) {
+            for (auto ind = begin; ind < end; ++ind) {
+                ++visits[ind];
+            }
+        });
+        std::size_t visited_once{};
+        for (auto const& visit : visits) {
+            visited_once += visit == 1 ? 1 : 0;
+        }
+        CHECK(visited_once == count);
+    }
+
+    SECTION("nested")
+    {
+        // waiting chunks run nested chunks, so pool is not exhausted
+        std::atomic<std::size_t> total{};
+        pool.for_each_chunk(64, 1, [&](std::size_t begin, std::size_t end) {
+            for (auto ind = begin; ind < end; ++ind) {
+                pool.for_each_chunk(100, 1, [&](std::size_t inner_begin, std::size_t inner_end) {
+                    total += inner_end - inner_begin;
+                });
+            }
+        });
+        CHECK(total == 6'400);
+    }
+
+    SECTION("empty")
+    {
+        bool called{};
+        pool.for_each_chunk(0, 1, [&](std::size_t, std::size_t) { called = true; });
+        CHECK(!called);
+    }
+}
@@ -93,3 +93,38 @@ tags:
         }
     }
 }
+
+TEST_CASE("Branched rule with serialization script")
+{
+    using namespace dynser_test;
+
+    // branching script runs after serialization script and sees its 'out' table
+    const auto config = R"##(---
+version: ''
+tags:
+  - name: "signed"
+    branched:
+      branching-script: |
+        branch = out['abs'] == tostring(inp['value']:as_i32()) and 0 or 1
+      debranching-script: ''
+      rules:
+        - linear: { pattern: '\+(\d+)', fields: { 1: abs } }
+        - linear: { pattern: '-(\d+)', fields: { 1: abs } }
+    serialization-script: |
+      out['abs'] = tostring(math.abs(inp['value']:as_i32()))
+...)##";
+
+    auto ser = get_dynser_instance();
+
+    DYNSER_LOAD_CONFIG(ser, dynser::config::RawContents{ config });
+
+    const std::pair<Quux, std::string> quuxs[]{
+        { { 5 }, "+5" },
+        { { -7 }, "-7" },
+        { { 0 }, "+0" },
+    };
+
+    for (auto const& [quux, expected] : quuxs) {
+        DYNSER_TEST_SERIALIZE(quux, "signed", expected);
+    }
+}
@@ -1,5 +1,7 @@
 #include "common.hpp"
 
+#include <thread>
+
 TEST_CASE("Continual rule #0")
 {
     using namespace dynser_test;
@@ -97,3 +99,163 @@ tags:
         }
     }
 }
+
+TEST_CASE("Serialize to sink")
+{
+    using namespace dynser_test;
+
+    const auto config =
+#include "../configs/continual.yaml.raw"
+        ;
+
+    auto ser = get_dynser_instance();
+
+    DYNSER_LOAD_CONFIG(ser, dynser::config::RawContents{ config });
+
+    const Pos pos{ 1, 2 };
+
+    SECTION("string")
+    {
+        std::string out{ "pos: " };
+        REQUIRE(ser.serialize_to(out, pos, "pos"));
+        CHECK(out == "pos: 1, 2");
+
+        // output is left unchanged on error
+        CHECK(!ser.serialize_to(out, pos, "non-existent-tag"));
+        CHECK(out == "pos: 1, 2");
+    }
+
+    SECTION("stream")
+    {
+        std::ostringstream out;
+        REQUIRE(ser.serialize_to(out, pos, "pos"));
+        CHECK(out.str() == "1, 2");
+    }
+
+    SECTION("callback")
+    {
+        std::string out;
+        auto sink = [&out](std::string_view fragment) { out += fragment; };
+        REQUIRE(ser.serialize_to(sink, pos, "pos"));
+        CHECK(out == "1, 2");
+    }
+}
+
+TEST_CASE("Serialize batch")
+{
+    using namespace dynser_test;
+
+    const auto config =
+#include "../configs/continual.yaml.raw"
+        ;
+
+    auto ser = get_dynser_instance();
+
+    DYNSER_LOAD_CONFIG(ser, dynser::config::RawContents{ config });
+
+    const std::vector<Pos> poss{ { 1, 2 }, { -1, -3 }, { 0, 42 } };
+
+    SECTION("targets")
+    {
+        const auto batch = ser.serialize_batch<Pos>(poss, "pos");
+        REQUIRE(batch);
+        REQUIRE(batch->size() == 3);
+        CHECK((*batch)[0] == "1, 2");
+        CHECK((*batch)[1] == "-1, -3");
+        CHECK((*batch)[2] == "0, 42");
+        CHECK(batch->buffer == "1, 2-1, -30, 42");
+    }
+
+    SECTION("properties")
+    {
+        std::vector<dynser::Properties> props;
+        for (const auto& pos : poss) {
+            props.push_back(ser.ttpm(ser.context, pos));
+        }
+
+        dynser::SerializedBatch out;
+        REQUIRE(ser.serialize_batch(props, "pos", out));
+        REQUIRE(out.size() == 3);
+        CHECK(out[1] == "-1, -3");
+
+        // output is left unchanged on error
+        CHECK(!ser.serialize_batch(props, "non-existent-tag", out));
+        CHECK(out.size() == 3);
+        CHECK(out.buffer == "1, 2-1, -30, 42");
+
+        std::vector<std::string> records;
+        auto sink = [&records](std::string_view record) { records.emplace_back(record); };
+        REQUIRE(ser.serialize_batch(props, "pos", sink));
+        CHECK(records == std::vector<std::string>{ "1, 2", "-1, -3", "0, 42" });
+    }
+
+    SECTION("parallel")
+    {
+        std::vector<Pos> many_poss;
+        for (int i{}; i < 100; ++i) {
+            many_poss.push_back({ i, -i });
+        }
+        ser.set_thread_pool(std::make_shared<dynser::parallel::ThreadPool>(4));
+
+        const auto results = ser.serialize_batch_parallel<Pos>(many_poss, "pos");
+        REQUIRE(results.size() == many_poss.size());
+        std::size_t mismatches{};
+        for (int i{}; i < 100; ++i) {
+            const auto& result = results[static_cast<std::size_t>(i)];
+            if (!result || *result != std::to_string(i) + ", " + std::to_string(-i)) {
+                ++mismatches;
+            }
+        }
+        CHECK(mismatches == 0);
+
+        // failed records don't stop others
+        const std::vector<dynser::Properties> props{ ser.ttpm(ser.context, poss[0]), dynser::Properties{} };
+        const auto props_results = ser.serialize_batch_parallel(props, "pos");
+        REQUIRE(props_results.size() == 2);
+        CHECK(props_results[0]);
+        CHECK(!props_results[1]);
+    }
+}
+
+TEST_CASE("Serialize in sessions")
+{
+    using namespace dynser_test;
+
+    const auto config =
+#include "../configs/continual.yaml.raw"
+        ;
+
+    auto ser = get_dynser_instance();
+
+    DYNSER_LOAD_CONFIG(ser, dynser::config::RawContents{ config });
+
+    // config is loaded once and shared
+    auto session = ser.session();
+    CHECK(session.shared_config() == ser.shared_config());
+    // mappers and caches are not copied, targets are mapped by owner
+    static_assert(std::same_as<decltype(session), dynser::Session>);
+
+    constexpr std::size_t threads_count = 4;
+    std::vector<std::size_t> mismatches(threads_count);
+    {
+        std::vector<std::jthread> threads;
+        for (std::size_t thread_ind{}; thread_ind < threads_count; ++thread_ind) {
+            threads.emplace_back([&ser, &mismatches, thread_ind] {
+                auto thread_session = ser.session();
+                for (int i{}; i < 100; ++i) {
+                    const auto result = thread_session.serialize_props(ser.ttpm(ser.context, Pos{ i, -i }), "pos");
+                    if (!result || *result != std::to_string(i) + ", " + std::to_string(-i)) {
+                        ++mismatches[thread_ind];
+                    }
+                }
+            });
+        }
+    }
+    CHECK(mismatches == std::vector<std::size_t>(threads_count));
+
+    // merge doesn't change config of other sessions
+    const auto shared = ser.shared_config();
+    REQUIRE(ser.merge_config(dynser::config::RawContents{ config }));
+    CHECK(session.shared_config() == shared);
+    CHECK(ser.shared_config() != shared);
+}
@@ -102,6 +102,67 @@ tags:
         }
     }
 
+    SECTION("invalid script in config")
+    {
+        const char* const configs[]{
+            R"##(---
+version: ''
+tags:
+  - name: "1"
+    continual: []
+    serialization-script: |
+      out['value'] = = inp['value']
+...)##",
+            R"##(---
+version: ''
+tags:
+  - name: "1"
+    branched: { branching-script: 'branch = ', debranching-script: '', rules: [] }
+...)##",
+        };
+
+        for (std::size_t ind{}; auto const config : configs) {
+            DYNAMIC_SECTION("Config: #" << ind)
+            {
+                // syntax errors must be found on load, not on first serialize
+                const auto load_result = ser.load_config(config::RawContents{ config });
+
+                INFO(
+                    "Load result is: "
+                    << (load_result ? "ok" : Printer{}.config_parse_err_to_string(load_result.error()))
+                );
+                REQUIRE_FALSE(load_result);
+                CHECK(load_result.error().type == config::ParseError::Type::ScriptSyntaxError);
+            }
+            ++ind;
+        }
+    }
+
+    SECTION("unfinished deserialization script in config")
+    {
+        const auto config = R"##(---
+version: ''
+tags:
+  - name: "1"
+    continual: [ linear: { pattern: '(\d+)', fields: { 1: value } } ]
+    serialization-script: |
+      out['value'] = inp['value']:as_string()
+    deserialization-script: |
+      not implemented
+...)##";
+
+        // config may be used for serialization only, error is reported on deserialization
+        DYNSER_LOAD_CONFIG(ser, config::RawContents{ config });
+
+        const auto serialize_result = ser.serialize_props(util::map_to_props("value", "42"), "1");
+        REQUIRE(serialize_result);
+        CHECK(*serialize_result == "42");
+
+        const auto deserialize_result = ser.deserialize_to_props("42", "1");
+        REQUIRE_FALSE(deserialize_result);
+        CHECK(std::holds_alternative<deserialize_err::ScriptError>(deserialize_result.error().error));
+    }
+
     SECTION("invalid tags")
     {
         DYNSER_LOAD_CONFIG(ser, config::RawContents{ "{ version: '', tags: [] }" });
@@ -26,3 +26,91 @@ TEST_CASE("Recurrent rule")
         }
     }
 }
+
+TEST_CASE("Recurrent rule chunked")
+{
+    using namespace dynser_test;
+
+    const auto config =
+#include "../configs/recurrent.yaml.raw"
+        ;
+
+    auto ser = get_dynser_instance();
+
+    DYNSER_LOAD_CONFIG(ser, dynser::config::RawContents{ config });
+
+    const std::vector<Pos> list{ { -1, -254 }, { 123, 0 }, { 00, 2 } };
+    const std::string expected{ "[ ( -1, -254 ), ( 123, 0 ), ( 0, 2 ) ]" };
+
+    std::vector<std::string> chunks;
+    auto sink = [&chunks](std::string_view chunk) { chunks.emplace_back(chunk); };
+
+    SECTION("small chunks")
+    {
+        // chunk is passed after every rule
+        REQUIRE(ser.serialize_chunked(list, "pos-list", 1, sink));
+        CHECK(chunks.size() > list.size());
+    }
+
+    SECTION("chunk larger than output")
+    {
+        REQUIRE(ser.serialize_chunked(list, "pos-list", 1024, sink));
+        CHECK(chunks.size() == 1);
+    }
+
+    SECTION("serialize from sink")
+    {
+        // nested calls (chunked too) don't pass their output to outer sink
+        std::size_t nested_mismatches{};
+        auto serializing_sink = [&](std::string_view chunk) {
+            chunks.emplace_back(chunk);
+            std::string nested_chunks;
+            auto nested_sink = [&nested_chunks](std::string_view nested_chunk) { nested_chunks += nested_chunk; };
+            if (!ser.serialize_chunked(list, "pos-list", 1, nested_sink) || nested_chunks != expected ||
+                ser.serialize(list, "pos-list") != expected)
+            {
+                ++nested_mismatches;
+            }
+        };
+        REQUIRE(ser.serialize_chunked(list, "pos-list", 1, serializing_sink));
+        CHECK(nested_mismatches == 0);
+    }
+
+    std::string joined;
+    for (const auto& chunk : chunks) {
+        joined += chunk;
+    }
+    CHECK(joined == expected);
+}
+
+TEST_CASE("Recurrent rule to sink")
+{
+    using namespace dynser_test;
+
+    const auto config =
+#include "../configs/recurrent.yaml.raw"
+        ;
+
+    auto ser = get_dynser_instance();
+
+    DYNSER_LOAD_CONFIG(ser, dynser::config::RawContents{ config });
+
+    std::vector<Pos> list;
+    for (int i{}; i < 2'000; ++i) {
+        list.push_back({ i, -i });
+    }
+    const auto expected = ser.serialize(list, "pos-list");
+    REQUIRE(expected);
+
+    // long output is passed in fragments, not as one string
+    std::vector<std::string> fragments;
+    auto sink = [&fragments](std::string_view fragment) { fragments.emplace_back(fragment); };
+    REQUIRE(ser.serialize_to(sink, list, "pos-list"));
+    CHECK(fragments.size() > 1);
+
+    std::string joined;
+    for (const auto& fragment : fragments) {
+        joined += fragment;
+    }
+    CHECK(joined == *expected);
+}
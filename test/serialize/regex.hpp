@@ -58,6 +58,50 @@ TEST_CASE("Regex")
     }
 }
 
+TEST_CASE("Regex parallel")
+{
+    using namespace dynser_test;
+    using namespace dynser::regex;
+
+    dynser::DynSer ser{
+        dynser::generate_property_to_target_mapper(),
+        dynser::generate_target_to_property_mapper([&](dynser::Context&, Regex const& target) -> dynser::Properties {
+            return regex_to_props_helper(target);
+        })
+    };
+
+    const auto config =
+#include "../configs/regex.yaml.raw"
+        ;
+
+    DYNSER_LOAD_CONFIG(ser, dynser::config::RawContents{ config });
+
+    std::string regex_str;
+    for (int i{}; i < 500; ++i) {
+        regex_str += R"(a(b)[^c]\d+?(?:e))";
+    }
+    auto const regex = from_string(regex_str);
+    REQUIRE(regex);
+
+    // every recurrent-dict is split between workers, output is same as sequential one
+    ser.set_thread_pool(std::make_shared<dynser::parallel::ThreadPool>(4), 1);
+    DYNSER_TEST_SERIALIZE(*regex, "regex", regex_str);
+
+    // chunks of workers are flushed in order of elements
+    std::string joined;
+    std::size_t chunks_count{};
+    auto sink = [&](std::string_view chunk) {
+        joined += chunk;
+        ++chunks_count;
+    };
+    REQUIRE(ser.serialize_chunked(*regex, "regex", 64, sink));
+    CHECK(joined == regex_str);
+    CHECK(chunks_count > 1);
+
+    ser.set_thread_pool(nullptr);
+    DYNSER_TEST_SERIALIZE(*regex, "regex", regex_str);
+}
+
 auto quantifier_to_props(dynser::regex::Quantifier const& value) -> dynser::Properties
 {
     using dynser::util::map_to_props;
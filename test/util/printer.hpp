@@ -96,6 +96,14 @@ struct Printer
                     error.mark.column,
                     error.msg
                 );
+            case ScriptSyntaxError:
+                return std::format(
+                    "lua syntax error at 'pos: {}, line: {}, col: {}' with msg: {}",
+                    error.mark.pos,
+                    error.mark.line,
+                    error.mark.column,
+                    error.msg
+                );
             case UnknownException:
                 return std::format("unknown exception");
         }
@@ -140,6 +148,9 @@ struct Printer
         if (value.is_string()) {
             return value.as_const_string();
         }
+        if (value.is_string_view()) {
+            return std::string{ value.as_const_string_view() };
+        }
         DYNSER_USE_STD_TO_STRING(bool)
         DYNSER_USE_STD_TO_STRING(char)
         if (value.is_list()) {